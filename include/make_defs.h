@@ -25,6 +25,13 @@
 #define LINUX_HW_IMPL_WSL               WSL
 #define LINUX_HW_IMPL_ARM               ARM
 
+// Возможные значения RTOS_HW_IMPL
+#define STM32                           (30)
+#define SIM                             (40)
+// C префиксами для ясности:
+#define RTOS_HW_IMPL_STM32              STM32
+#define RTOS_HW_IMPL_SIM                SIM
+
 // // Возможные значения LIBIEC
 // #define LINUX                           (1)
 // // C префиксами для ясности:
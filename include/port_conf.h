@@ -32,7 +32,10 @@
 // Enable debug mode
 #define PORT_DBG_EN                     (1)
 
-// Time to lock nRE/DE in push-up, ms
-#define PORT_RS485_DE_WAIT              (1)
+// Max time to wait for line in rs485_poll_rx() if wake descriptor is set, ms
+#define PORT_RS485_RX_WAIT              (10)
+
+// Cache line size, bytes
+#define PORT_CACHE_LINE                 (64)
 
 #endif //PORT_CONF_H
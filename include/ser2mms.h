@@ -11,7 +11,12 @@
 #include "transp.h"
 #include "ser.h"
 #include "mms_if.h"
+#include "map.h"
+#include "goose.h"
+#include "answ.h"
+#include "loop.h"
 #include "port_rs485_init.h"
+#include "port_thread.h"
 
 /** Use static allocation. */
 #define SER2MMS_USE_STATIC (0) //S2M_USE_STATIC
@@ -25,6 +30,10 @@
 #define S2M_SET_ATTRS_S32 MMS_SET_ATTRS_S32
 #define S2M_GET_TIME ser_get_time
 
+/** Ready flags of ser2mms_process (bit N - descriptor N of ser2mms_get_fds). */
+#define S2M_EV_RX (1U << 0)         // Serial port is readable
+#define S2M_EV_ALL (0xffffffffU)    // Check everything (no descriptors)
+
 // Type declarations
 
 /** Main ser2mms object structure. */
@@ -33,6 +42,20 @@ typedef struct ser2mms_s ser2mms_t;
 /** Type alias for brevity. */
 typedef ser2mms_t s2m_t;
 
+/** User callbacks of one instance (see ser_ops_t). */
+typedef ser_ops_t s2m_ops_t;
+
+/** Scheduler driving many instances from one thread. */
+typedef struct loop_s s2m_loop_t;
+
+/** Run options, zero-initialized structure gives default behaviour. */
+typedef struct {
+  thread_attr_t thread;   // Worker thread attributes (priority, CPUs, stack)
+  bool lock_mem;          // Lock process memory in RAM (mlockall)
+  bool no_thread;         // Don't create worker thread, instance is driven
+                          // by ser2mms_process from external event loop
+} s2m_opt_t;
+
 // Public interface function declarations
 
 // Basic functions
@@ -46,10 +69,14 @@ typedef ser2mms_t s2m_t;
 * @param mode operation mode (S2M_SLAVE or S2M_POLL)
 * @param id device identifier
 * @param stty_init pointer to transport initialization structure
+* @param ops user callbacks, NULL (or NULL member) - global ser2mms_*
+*        functions below
+* @param ctx context passed to callbacks (NULL - pointer to this object)
 * @return if object created - pointer to object,
 *         if error occurred - NULL
 */
-s2m_t *ser2mms_new(void *ied, u32_t mode, u32_t id, void *stty_init);
+s2m_t *ser2mms_new(void *ied, u32_t mode, u32_t id, void *stty_init,
+                   const s2m_ops_t *ops, void *ctx);
 
 /**
 * Object destructor.
@@ -63,12 +90,108 @@ void ser2mms_destroy(s2m_t *);
 /**
 * Start operation.
 * In multithreaded mode creates worker thread, in single-threaded - just
-* starts transport layer.
+* starts transport layer. On error object stays as it was before the call
+* and may be run again.
 *
 * @param self pointer to object
+* @param opt run options (NULL - default)
 * @return 0 on success, -1 on error
 */
-s32_t ser2mms_run(s2m_t *);
+s32_t ser2mms_run(s2m_t *, const s2m_opt_t *);
+
+/**
+* Get descriptors of instance for external event loop.
+* Descriptors are waited for readability (poll/epoll/select) together with
+* the rest of application, first one is serial port, second (if supported
+* by port) is event queue. Used without worker thread (ser2mms_run not
+* called or S2M_USE_THREADS disabled).
+*
+* @param self pointer to object
+* @param fds array to place descriptors
+* @param max array size
+* @return number of descriptors placed
+*/
+u32_t ser2mms_get_fds(s2m_t *, fd_t *fds, u32_t max);
+
+/**
+* Get time to next deadline of instance.
+* External event loop must not sleep longer than this before calling
+* ser2mms_process.
+*
+* @param self pointer to object
+* @return time, ms (0 - expired, -1 - no deadline)
+*/
+s32_t ser2mms_get_timeout(s2m_t *);
+
+/**
+* Process instance without blocking.
+* Reads serial port if it's ready, handles queued events and deadlines.
+*
+* @param self pointer to object
+* @param ready ready flags, bit N is set if descriptor N is readable
+* (S2M_EV_RX, S2M_EV_ALL)
+* @return 0 on success, -1 if worker thread is running
+*/
+s32_t ser2mms_process(s2m_t *, u32_t ready);
+
+/**
+* Scheduler constructor.
+* Scheduler drives up to S2M_LOOP_MAX_SESSIONS instances from the calling
+* thread, instead of worker thread per instance.
+*
+* @return pointer to scheduler or NULL on error
+*/
+s2m_loop_t *ser2mms_loop_new(void);
+
+/**
+* Scheduler destructor. Instances are not destroyed, they must be removed
+* (ser2mms_loop_del) or destroyed before.
+*
+* @param loop pointer to scheduler
+*/
+void ser2mms_loop_destroy(s2m_loop_t *);
+
+/**
+* Add instance to scheduler.
+* Instance must be started with no_thread option (see s2m_opt_t).
+*
+* @param loop pointer to scheduler
+* @param self pointer to object
+* @return 0 on success, -1 on error
+*/
+s32_t ser2mms_loop_add(s2m_loop_t *, s2m_t *);
+
+/**
+* Remove instance from scheduler.
+* Its descriptors are no longer waited for, instance may be reconfigured,
+* added again or destroyed (destructor removes it itself).
+*
+* @param loop pointer to scheduler
+* @param self pointer to object
+* @return 0 on success, -1 if instance isn't added to this scheduler
+*/
+s32_t ser2mms_loop_del(s2m_loop_t *, s2m_t *);
+
+/**
+* Run one pass of scheduler.
+* Waits until some instance is ready or its deadline comes and processes
+* such instances.
+*
+* @param loop pointer to scheduler
+* @param wait_ms maximum time to wait, ms (-1 - until something happens)
+* @return number of processed instances, -1 on error
+*/
+s32_t ser2mms_loop_run(s2m_loop_t *, s32_t wait_ms);
+
+/**
+* Stop operation.
+* Requests worker thread to stop, wakes it from waiting for line and waits
+* for its exit, so shutdown takes one pass of transport loop at most.
+* Instance can be started again by ser2mms_run. Called by ser2mms_destroy.
+*
+* @param self pointer to object
+*/
+void ser2mms_stop(s2m_t *);
 
 /**
 * Polling function.
@@ -80,7 +203,85 @@ s32_t ser2mms_run(s2m_t *);
 */
 void ser2mms_poll(s2m_t *);
 
+/**
+* Load attribute mapping table.
+* After loading, received page and subscription values are written to the
+* data model by the library and ser2mms_read_page/ser2mms_read_subs (or
+* ser2mms_read_frame) are not called. Must be called before ser2mms_run
+* or after ser2mms_stop, fails while instance is running. Replaces table
+* loaded before, publisher and store of previous run are released.
+* See map.h for file format.
+*
+* @param self pointer to object
+* @param path path to mapping file
+* @return 0 on success, -1 on error
+*/
+s32_t ser2mms_load_map(s2m_t *, const char *);
+
+/**
+* Set static attribute mapping table.
+* Same as ser2mms_load_map, but uses fully resolved table linked into the
+* application (see tools/s2m_gen.py), nothing is parsed at startup.
+*
+* @param self pointer to object
+* @param tbl table of MAP_NUM_ENTS entries
+* @return 0 on success, -1 on error
+*/
+s32_t ser2mms_set_map(s2m_t *, const map_ent_t *);
+
+/**
+* Set answer attributes.
+* Answer of SLAVE reply is kept encoded and updated by write handlers of
+* given attributes, ser2mms_write_answer is not called. Value written by
+* client appears in the next reply. Can't be called after ser2mms_run or
+* ser2mms_loop_add; call ser2mms_stop or ser2mms_loop_del first to replace
+* the answer.
+*
+* @param self pointer to object
+* @param attrs answer attributes in reply order
+* @param num number of attributes (up to SER_ANSW_SIZE)
+* @return 0 on success, -1 on error or if object is running
+*/
+s32_t ser2mms_set_answer(s2m_t *, DataAttribute *const *, u32_t);
+
+/**
+* Set answer value changed locally.
+* Updating attribute in data model doesn't call its write handler, so value
+* changed not by client write is passed here. May be called while running.
+*
+* @param self pointer to object
+* @param idx index of attribute given to ser2mms_set_answer
+* @param value new value
+* @return 0 on success, -1 if answer isn't set or index is out of range
+*/
+s32_t ser2mms_set_answer_value(s2m_t *, u32_t, s16_t);
+
+#if (S2M_USE_GOOSE)
+/**
+* Enable GOOSE fast path.
+* Selected subscription values are published as GOOSE messages directly
+* from serial thread as soon as frame is decoded. Serial thread uses the
+* publisher without locking, so it can't be replaced after ser2mms_run or
+* ser2mms_loop_add; call ser2mms_stop or ser2mms_loop_del first.
+*
+* @param self pointer to object
+* @param cfg publisher settings
+* @return 0 on success, -1 on error or if object is running
+*/
+s32_t ser2mms_set_goose(s2m_t *, const goose_cfg_t *);
+
+/**
+* Get GOOSE fast path statistics.
+*
+* @param self pointer to object
+* @param stats pointer to place statistics
+* @return 0 on success, -1 if GOOSE isn't enabled
+*/
+s32_t ser2mms_get_goose_stats(s2m_t *, goose_stats_t *);
+#endif
+
 // Functions with external implementation
+// Default callbacks, used by instances created without own ones (ops)
 
 /** For SLAVE mode. */
 
@@ -104,6 +305,20 @@ void ser2mms_read_page(const page_prm_t *buf, u8_t ds, u8_t page, void *opaque);
 */
 void ser2mms_read_subs(const sub_prm_t *buf, void *opaque);
 
+#if (S2M_USE_FRAME_VIEW)
+/**
+* Read received frame.
+* Replaces ser2mms_read_page/ser2mms_read_subs when S2M_USE_FRAME_VIEW is
+* set and values are not applied by mapping table, publisher or store.
+* Values are decoded by frame_page, frame_mag and frame_ts on access.
+* Function must be implemented by user
+*
+* @param[in] frm view over frame, valid only during call
+* @param[in] opaque opaque context pointer
+*/
+void ser2mms_read_frame(const frame_view_t *frm, void *opaque);
+#endif
+
 /**
 * Write answer.
 * Function must be implemented by user
@@ -164,6 +379,7 @@ void *ser2mms_get_ied(s2m_t *);
 
 /**
 * Setter for transmitted command type (only in S2M_POLL mode).
+* Command is queued and takes effect from the next request.
 *
 * @param self pointer to object
 * @param cmd new command
@@ -172,12 +388,51 @@ void ser2mms_set_cmd(s2m_t *, u32_t);
 
 /**
 * Device ID setter.
+* May be called from any thread, new ID is used from the next frame.
 *
 * @param self pointer to object
 * @param id new ID value
 */
 void ser2mms_set_id(s2m_t *, u32_t);
 
+/**
+* Getter for number of events lost because event queue was full.
+*
+* @param self pointer to object
+* @return number of lost events
+*/
+u32_t ser2mms_get_ev_lost(s2m_t *);
+
+/**
+* Getter for number of requests left without reply.
+* Request is repeated S2M_RSP_RETRIES times if reply doesn't come in
+* S2M_RSP_TIMEOUT_MS (POLL mode).
+*
+* @param self pointer to object
+* @return number of requests
+*/
+u32_t ser2mms_get_rsp_lost(s2m_t *);
+
+/**
+* Getter for number of master retries answered from cache.
+* Identical request within S2M_DUP_WINDOW_MS after accepted one gets
+* the last reply without parsing and writing attributes again.
+*
+* @param self pointer to object
+* @return number of retries
+*/
+u32_t ser2mms_get_dup_hits(s2m_t *);
+
+/**
+* Getter for receive statistics.
+* Shows how often the frame was caught by busy-poll window (spin_us of
+* rs485_init_t) and how often receiver had to block.
+*
+* @param self pointer to object
+* @param stats pointer to place statistics
+*/
+void ser2mms_get_rx_stats(s2m_t *, rs485_stats_t *stats);
+
 /**
 * Test tick.
 * Used for debugging and testing. Performs one processing step
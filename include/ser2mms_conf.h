@@ -25,10 +25,70 @@
 /** Use static allocation. */
 #define S2M_USE_STATIC                  (0)
 
+/** POLL mode: receive and transmit in separate threads (needs threads). */
+#define S2M_USE_SPLIT_RXTX              (0)
+
+#if (S2M_USE_SPLIT_RXTX) && (!S2M_USE_THREADS)
+#error "Macro 'S2M_USE_THREADS' must be enabled if you're using 'S2M_USE_SPLIT_RXTX'"
+#endif
+
 /** Implementation selection for 'transp' interface. */
 #define S2M_USE_TRANSP_RTU              (1) // Use RTU
 #define S2M_USE_TRANSP_TCP              (0) // Use TCP
 
+/** Time without bytes after which partly received frame is dropped, in
+ * character times at configured line rate. */
+#define S2M_RX_GAP_CHARS                (4)
+
+/** Lower bound of that time (OS scheduling, USB adapter latency), ms. */
+#define S2M_RX_GAP_MS                   (5)
+
+/** Build next message ahead. POLL mode: next request while current one
+ * waits for reply, so its values go out one poll period late. SLAVE mode:
+ * reply from precomputed answer, rebuilt when answer changes. Off by
+ * default, values are read when request is due. */
+#define S2M_XMIT_PREBUILD               (0)
+
+/** Maximum sessions (instances) driven by one scheduler. */
+#define S2M_LOOP_MAX_SESSIONS          (1024)
+
+/** POLL mode: time to wait for reply before request is repeated, ms. */
+#define S2M_RSP_TIMEOUT_MS              (100)
+
+/** POLL mode: number of repeats of unanswered request. */
+#define S2M_RSP_RETRIES                 (0)
+
+/** SLAVE mode: identical request within this time after accepted one is
+ * master's retry, it gets the last reply without parsing, ms (0 - off). */
+#define S2M_DUP_WINDOW_MS               (0)
+
+/** SLAVE mode: hand received frame to ser2mms_read_frame() as read-only view
+ * instead of decoding it for ser2mms_read_page()/ser2mms_read_subs(). */
+#define S2M_USE_FRAME_VIEW              (0)
+
+/** Publish decoded frames to IED server from separate thread. */
+#define S2M_USE_PUB                     (0)
+
+/** Publisher queue depth, frames (power of 2). */
+#define S2M_PUB_DEPTH                   (16)
+
+/** Publisher back-pressure policy selection */
+#define S2M_PUB_DROP_OLDEST             (0) // Drop oldest queued frame
+#define S2M_PUB_COALESCE                (1) // Keep latest frame of each page
+
+/** Commit latest values of mapped points periodically from separate thread. */
+#define S2M_USE_STORE                   (0)
+
+/** Store flush period, ms. */
+#define S2M_STORE_FLUSH_MS              (100)
+
+#if (S2M_USE_PUB) && (S2M_USE_STORE)
+#error "Select only one of 'S2M_USE_PUB' and 'S2M_USE_STORE'"
+#endif
+
+/** Publish selected subscription values as GOOSE (needs LIBIEC). */
+#define S2M_USE_GOOSE                   (0)
+
 /** Use full LIBIEC library API or emulate it. */
 #ifdef LIBIEC
 #define S2M_USE_LIBIEC                  LIBIEC
@@ -0,0 +1,23 @@
+
+# ================ Генерация статической таблицы соответствия =================
+# Использование: make S2M_ICD=model.icd S2M_POINTS=points.txt
+# S2M_MODEL_H - заголовок статической модели libiec61850 (genmodel)
+
+S2M_GEN = $(SER2MMS_HOME)/tools/s2m_gen.py
+S2M_MODEL_H ?= static_model.h
+
+ifdef S2M_ICD
+ifndef S2M_POINTS
+$(error "S2M_POINTS must be defined together with S2M_ICD")
+endif
+
+GEN_DIR = gen
+GEN_NAME = s2m_map_gen
+GEN_SRCS = $(GEN_DIR)/$(GEN_NAME).c
+LIB_INC_DIRS += $(GEN_DIR)
+CFLAGS += -DS2M_USE_GEN_MAP=1
+
+$(GEN_DIR)/$(GEN_NAME).c: $(S2M_ICD) $(S2M_POINTS) $(S2M_GEN)
+	python3 $(S2M_GEN) --icd $(S2M_ICD) --points $(S2M_POINTS) \
+		--model-header $(S2M_MODEL_H) --out $(GEN_DIR)/$(GEN_NAME)
+endif
@@ -10,6 +10,10 @@ LIB_INC_DIRS += $(SER2MMS_HOME)/src/port/include
 
 PERIPHERY_HOME = $(SER2MMS_HOME)/third/c-periphery
 
+ifndef FREERTOS_HOME
+FREERTOS_HOME = $(SER2MMS_HOME)/third/FreeRTOS-Kernel
+endif
+
 ifndef LIBIEC
 LIBIEC = 1
 endif
@@ -28,6 +28,7 @@ endif
 # ================== Настройка тулчейна на основе ARCH + OS ====================
 
 LINUX_HW_IMPL =
+RTOS_HW_IMPL =
 
 # Архитектурные префиксы
 WSL_LINUX_TOOLCHAIN =
@@ -51,6 +52,14 @@ CFLAGS += -mcpu=cortex-a8 -mfloat-abi=hard -mfpu=neon
 CFLAGS += -Wall -g -Wextra
 endif
 
+# x86_64 + FreeRTOS (POSIX-симулятор)
+ifeq ($(ARCH)-$(OS), x86_64-rtos)
+RTOS_HW_IMPL = SIM
+TOOLCHAIN_PREFIX = $(WSL_LINUX_TOOLCHAIN)
+CFLAGS += -m64 -pthread
+CFLAGS += -Wall -g -Wextra
+endif
+
 # ARM + bare-metal
 # ifeq ($(ARCH)-$(OS), arm-bare)
 # TOOLCHAIN_PREFIX = $(ARM_BARE_TOOLCHAIN)
@@ -69,6 +78,10 @@ endif
 CFLAGS += -DPORT_IMPL=$(PORT_IMPL)
 # LINUX_HW_IMPL объявлен всегда, но имеет значение только, если PORT_IMPL==LINUX
 CFLAGS += -DLINUX_HW_IMPL=$(LINUX_HW_IMPL)
+# RTOS_HW_IMPL объявлен только, если PORT_IMPL==RTOS и вариант платы задан
+ifneq ($(RTOS_HW_IMPL),)
+CFLAGS += -DRTOS_HW_IMPL=$(RTOS_HW_IMPL)
+endif
 
 # ====================== Компилятор и директории сборки ========================
 
@@ -18,7 +18,7 @@ static void vSetSignal( int iSignalNr, void (*pSigHandler)(int) );
 static void handler_sigquit(int sig);
 static void handler_sigint(int sig);
 
-int running = 1;
+static int running = 1;
 static s2m_t *s2m = NULL;
 
 static rs485_init_t s2m_stty_init = {
@@ -44,12 +44,13 @@ int main(void)
   vSetSignal(SIGINT, handler_sigint);   // code (2) 'Ctrl+C'
 
   // init
+  // no own callbacks: global ser2mms_write_* functions below are used
   s2m = ser2mms_new(NULL, S2M_POLL, 12,
-                    (void *)&s2m_stty_init);
+                    (void *)&s2m_stty_init, NULL, NULL);
   assert(s2m);
 
   // run
-  ser2mms_run(s2m);
+  ser2mms_run(s2m, NULL);
   printf("Runned\r\n");
 
   // loop
@@ -9,6 +9,14 @@
 #include "ser2mms.h"
 #include "ser2mms_defs.h"
 
+// Static mapping table generated from ICD (see make/gen.mk)
+#ifndef S2M_USE_GEN_MAP
+#define S2M_USE_GEN_MAP (0)
+#endif
+#if (S2M_USE_GEN_MAP)
+#include "s2m_map_gen.h"
+#endif
+
 #if (PORT_IMPL==PORT_IMPL_LINUX)&&(LINUX_HW_IMPL==LINUX_HW_IMPL_ARM)
 #include "gpio.h"
 #include "port_thread.h"
@@ -27,10 +35,22 @@
 static void vSetSignal( int iSignalNr, void (*pSigHandler)(int) );
 static void handler_sigterm(int sig);
 static void handler_sigint(int sig);
+static void read_page(const page_prm_t *, u8_t, u8_t, void *);
+static void read_subs(const sub_prm_t *, void *);
+static void write_answer(answ_prm_t *, u32_t *, void *);
+static void set_time(u32_t *, u32_t *, void *);
 
-int running = 1;
+static int running = 1;
 static s2m_t *s2m = NULL;
 
+// Callbacks of this line, they get IED server as context
+static const s2m_ops_t s2m_ops = {
+  .read_page = read_page,
+  .read_subs = read_subs,
+  .write_answer = write_answer,
+  .set_time = set_time
+};
+
 static rs485_init_t s2m_stty_init = {
 #if (PORT_IMPL==PORT_IMPL_LINUX)
 #if (LINUX_HW_IMPL==LINUX_HW_IMPL_WSL)
@@ -55,20 +75,39 @@ int main(void)
   // code (2) 'Ctrl+C'
   vSetSignal(SIGINT, handler_sigint);
 
+  // MMS stack (in-memory stand-in without libiec61850)
+#if (!S2M_USE_LIBIEC)
+  IedServer ied = iedsim_new();
+  if (!ied) {
+    perror("Can't create IED server stand-in");
+    exit(1);
+  }
+#else
+  void *ied = NULL;
+#endif
+
   // init
   s2m_t *s2m = ser2mms_new(
-    NULL,                   // MMS stack
+    (void *)ied,            // MMS stack
     S2M_SLAVE,              // Mode (SLAVE or POLL)
     12,                     // Address
-    (void *)&s2m_stty_init  // Configuration
+    (void *)&s2m_stty_init, // Configuration
+    &s2m_ops,               // Callbacks
+    (void *)ied             // Context of callbacks
   );
   if (!s2m) {
     perror("Can't create s2m instance");
     exit(1);
   }
+#if (S2M_USE_GEN_MAP)
+  if (ser2mms_set_map(s2m, s2m_map_gen) < 0) {
+    perror("Can't set s2m mapping table");
+    exit(1);
+  }
+#endif
 
   // run
-  ser2mms_run(s2m);
+  ser2mms_run(s2m, NULL);
 
   // loop
   do {
@@ -77,20 +116,24 @@ int main(void)
 
   // close
   ser2mms_destroy(s2m);
+#if (!S2M_USE_LIBIEC)
+  printf("Attribute updates: %u\n", iedsim_get_updates(ied));
+  iedsim_destroy(ied);
+#endif
   return 0;
 }
 
 /**
 * Read page values
 */
-void ser2mms_read_page(const page_prm_t *buf, u8_t ds, u8_t page, void *opaque)
+static void read_page(const page_prm_t *buf, u8_t ds, u8_t page, void *ctx)
 {
-  (void)ds; (void)page; (void)buf; (void)opaque;
+  (void)ds; (void)page; (void)buf; (void)ctx;
 #if (!S2M_USE_LIBIEC)
   // printf("[write_carg_slave] Value #1: %02d\r\n", carg_buf[ 0]);
   // printf("[write_carg_slave] Value #1: %02d\r\n", carg_buf[ 1]);
   // printf("[write_carg_slave] Value #1: %02d\r\n", carg_buf[ 2]);
-  void *ied = ser2mms_get_ied((s2m_t *)opaque);
+  void *ied = ctx;
   S2M_SET_PARAMS_S32(GGIO0, ConnStatus, HV, LV, buf);
 #endif // S2M_USE_LIBIEC
 }
@@ -98,14 +141,14 @@ void ser2mms_read_page(const page_prm_t *buf, u8_t ds, u8_t page, void *opaque)
 /**
 * Read subscription values
 */
-void ser2mms_read_subs(const sub_prm_t *buf, void *opaque)
+static void read_subs(const sub_prm_t *buf, void *ctx)
 {
-  (void)opaque; (void)buf;
+  (void)ctx; (void)buf;
 #if (!S2M_USE_LIBIEC)
   // printf("[write_subs_slave] Value #1: %02d\r\n", subs_buf[ 0].sl);
   // printf("[write_subs_slave] Epoch #1: %010d\r\n", subs_buf[ 0].pul[0]);
   // printf("[write_subs_slave] Usec #1: %d\r\n", subs_buf[ 0].pul[1]);
-  void *ied = ser2mms_get_ied((s2m_t *)opaque);
+  void *ied = ctx;
   S2M_SET_ATTRS_S32(GGIO0, ConnStatus, buf[0].mag, buf[0].t, true);
 #endif // S2M_USE_LIBIEC
 }
@@ -113,7 +156,8 @@ void ser2mms_read_subs(const sub_prm_t *buf, void *opaque)
 /**
 * Write answer
 */
-void ser2mms_write_answer(answ_prm_t *answ_buf, u32_t *answ_len)
+static void write_answer(answ_prm_t *answ_buf, u32_t *answ_len,
+                         __UNUSED void *ctx)
 {
   u32_t cnt = 0;
   // (void)answ_buf;
@@ -149,7 +193,7 @@ void ser2mms_write_answer(answ_prm_t *answ_buf, u32_t *answ_len)
 /**
 * Set system time
 */
-void ser2mms_set_time(uint32_t *epoch, uint32_t *usec)
+static void set_time(u32_t *epoch, u32_t *usec, __UNUSED void *ctx)
 {
   assert(epoch && usec);
 #if (PORT_IMPL==PORT_IMPL_LINUX)
@@ -0,0 +1,186 @@
+/**
+ * @file answ.c
+ * @author Ilia Proniashin, msg@proglyk.ru
+ * @date 18-October-2026
+ *
+ * Precomputed answer implementation.
+ *
+ * Block is guarded by sequence counter (seqlock). Writers (IED server
+ * threads, local updates) take it by moving counter to odd value with CAS,
+ * reader (serial thread) never blocks and retries only if it overlapped
+ * with a write.
+ */
+
+#include "answ.h"
+#include "alloc.h"
+#include "byteops.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * Internal answer object structure.
+ */
+struct answ_s {
+  atomic_uint seq;                          // Sequence counter
+  u32_t num;                                // Number of values
+  u8_t blk[ANSW_BLOCK_SIZE];                // Encoded answer block
+  void *ied;                                // IED server holding handlers
+  DataAttribute *attrs[SER_ANSW_SIZE];      // Answer attributes
+  u32_t num_hnd;                            // Number of installed handlers
+  mms_if_wr_hnd_t hnd;                      // Write handler registration
+};
+
+STATIC_DECLARE(ANSW, struct answ_s);
+
+// Private function declarations
+
+static bool on_write(DataAttribute *, s32_t, void *);
+static void off_write(answ_t);
+
+// Public interface function definitions
+
+// Basic functions
+
+/**
+ * Constructor.
+ */
+answ_t answ_new(void *ied, DataAttribute *const *attrs, u32_t num)
+{
+  s32_t value;
+  assert(ied && attrs);
+  if (num > SER_ANSW_SIZE) {
+    printf("[answ_new] Too many attributes (%u)\n", num);
+    return NULL;
+  }
+
+  ALLOC(ANSW, struct answ_s, self, return NULL);
+  atomic_init(&self->seq, 0);
+  self->num = num;
+  self->ied = ied;
+  self->hnd.cb = on_write;
+  self->hnd.ctx = (void *)self;
+
+  for (u32_t i=0; i<num; i++) {
+    assert(attrs[i]);
+    self->attrs[i] = attrs[i];
+    if (mms_if_get_attr_s32(attrs[i], &value)) {
+      // Value of model may be wider than reply field
+      if (value > INT16_MAX) value = INT16_MAX;
+      if (value < INT16_MIN) value = INT16_MIN;
+      answ_set(self, i, (s16_t)value);
+    }
+    if (!mms_if_on_write(ied, attrs[i], &self->hnd)) {
+      printf("[answ_new] Can't install write handler\n");
+      goto error;
+    }
+    self->num_hnd++;
+  }
+  return self;
+
+error:
+  off_write(self);
+  FREE(ANSW, self);
+  return NULL;
+}
+
+/**
+ * Destructor.
+ */
+void answ_destroy(answ_t self)
+{
+  assert(self);
+  off_write(self);
+  FREE(ANSW, self);
+}
+
+// Access to answer
+
+/**
+ * Set answer value.
+ */
+void answ_set(answ_t self, u32_t idx, s16_t value)
+{
+  assert(self && (idx < self->num));
+  u32_t seq = atomic_load_explicit(&self->seq, memory_order_relaxed);
+
+  // Take block: move counter from even to odd value
+  do {
+    seq &= ~1U;
+  } while (!atomic_compare_exchange_weak_explicit(&self->seq, &seq, seq + 1,
+                                                  memory_order_acquire,
+                                                  memory_order_relaxed));
+  atomic_thread_fence(memory_order_release);
+  S_TO_PB(self->blk + idx * 2, value);
+  atomic_store_explicit(&self->seq, seq + 2, memory_order_release);
+}
+
+/**
+ * Copy encoded answer block.
+ */
+u32_t answ_read(answ_t self, u8_t *buf)
+{
+  u32_t seq0, seq1;
+  assert(self && buf);
+
+  do {
+    seq0 = atomic_load_explicit(&self->seq, memory_order_acquire);
+    memcpy(buf, self->blk, self->num * 2);
+    atomic_thread_fence(memory_order_acquire);
+    seq1 = atomic_load_explicit(&self->seq, memory_order_relaxed);
+  } while ((seq0 & 1U) || (seq0 != seq1));
+  return self->num * 2;
+}
+
+/**
+ * Get number of answer values.
+ */
+u32_t answ_get_num(answ_t self)
+{
+  assert(self);
+  return self->num;
+}
+
+/**
+ * Get answer version.
+ */
+u32_t answ_get_ver(answ_t self)
+{
+  assert(self);
+  return atomic_load_explicit(&self->seq, memory_order_acquire) & ~1U;
+}
+
+// Private function definitions
+
+/**
+ * Write handler of answer attributes.
+ *
+ * @param attr written attribute
+ * @param value new value
+ * @param ctx pointer to answer object
+ * @return true if value fits reply field, false to reject write
+ */
+static bool on_write(DataAttribute *attr, s32_t value, void *ctx)
+{
+  answ_t self = (answ_t)ctx;
+  if ((value > INT16_MAX) || (value < INT16_MIN)) return false;
+  for (u32_t i=0; i<self->num; i++) {
+    if (self->attrs[i] == attr) answ_set(self, i, (s16_t)value);
+  }
+  return true;
+}
+
+/**
+ * Remove installed write handlers, so registration may be freed.
+ *
+ * @param self pointer to answer object
+ */
+static void off_write(answ_t self)
+{
+  for (u32_t i=0; i<self->num_hnd; i++) {
+    mms_if_off_write(self->ied, self->attrs[i]);
+  }
+  self->num_hnd = 0;
+}
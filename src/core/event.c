@@ -4,31 +4,62 @@
  * @date 30-September-2025
  * 
  * Event mechanism implementation.
+ *
+ * Queue is a bounded MPSC ring (D. Vyukov). Every cell holds sequence
+ * number: producers claim position by CAS on enqueue counter, fill cell
+ * and publish it by setting sequence to position + 1. Single consumer
+ * reads cell when its sequence says it's filled and frees it for the next
+ * lap by setting sequence to position + depth.
  */
 
 #include "event.h"
 #include "alloc.h"
+#include "port_conf.h"
 #if (EV_USE_THREADS)
 #include "port_semph.h"
+#include "port_tmr.h"
 #endif
 #include <stdio.h>
 #include <assert.h>
+#include <stdatomic.h>
 #include <string.h>
 #include <stdbool.h>
 
+#if (EV_QUEUE_DEPTH & (EV_QUEUE_DEPTH - 1))
+#error "Macro 'EV_QUEUE_DEPTH' must be power of 2"
+#endif
+
+/** Index mask of queue cell. */
+#define EV_MASK (EV_QUEUE_DEPTH - 1)
+
+/**
+ * Queue cell.
+ */
+typedef struct {
+  atomic_uint seq;  // Sequence number
+  ev_msg_t msg;     // Event
+} cell_t;
+
 /**
  * Internal event object structure.
  */
 struct event_s {
-  ev_type_t type;   // Event type
-  bool active;      // Event active flag
+  atomic_uint enq __ALIGNED(PORT_CACHE_LINE);  // Enqueue position (producers)
+  atomic_uint lost;                            // Number of lost events
+  u32_t deq __ALIGNED(PORT_CACHE_LINE);        // Dequeue position (consumer)
 #if (EV_USE_THREADS)
-  semph_t sem;      // Semaphore for synchronization
+  semph_t sem;                                 // Semaphore for synchronization
 #endif
+  cell_t cell[EV_QUEUE_DEPTH];                 // Queue cells
 };
 
 STATIC_DECLARE(EVENT, struct event_s);
 
+// Private function declarations
+
+static bool pop(ev_t, ev_msg_t *);
+static bool pending(ev_t);
+
 // Public interface function definitions
 
 /**
@@ -37,8 +68,10 @@ STATIC_DECLARE(EVENT, struct event_s);
 ev_t ev_new(void)
 {
   ALLOC(EVENT, struct event_s, self, return NULL);
-  self->type = EV_NONE;
-  self->active = false;
+  atomic_init(&self->enq, 0);
+  atomic_init(&self->lost, 0);
+  self->deq = 0;
+  for (u32_t i=0; i<EV_QUEUE_DEPTH; i++) atomic_init(&self->cell[i].seq, i);
 
 #if (EV_USE_THREADS)
   self->sem = semph_new();
@@ -66,37 +99,138 @@ void ev_destroy(ev_t self)
 /**
  * Post event.
  */
-void ev_post(ev_t self, ev_type_t type)
+bool ev_post(ev_t self, ev_type_t type, u32_t arg)
 {
+  cell_t *cell;
   assert(self);
-  self->type = type;
-  self->active = true;
+  u32_t pos = atomic_load_explicit(&self->enq, memory_order_relaxed);
+
+  for (;;) {
+    cell = &self->cell[pos & EV_MASK];
+    u32_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+    s32_t dif = (s32_t)(seq - pos);
+    if (dif == 0) {
+      // Cell is free, try to claim position
+      if (atomic_compare_exchange_weak_explicit(&self->enq, &pos, pos + 1,
+                                                memory_order_relaxed,
+                                                memory_order_relaxed)) break;
+    } else if (dif < 0) {
+      // Cell still holds event of previous lap: queue is full
+      atomic_fetch_add_explicit(&self->lost, 1, memory_order_relaxed);
+      return false;
+    } else {
+      pos = atomic_load_explicit(&self->enq, memory_order_relaxed);
+    }
+  }
+
+  cell->msg.type = type;
+  cell->msg.arg = arg;
+  atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
 
 #if (EV_USE_THREADS)
   semph_post(self->sem);
 #endif
+  return true;
 }
 
 /**
  * Get event.
  */
-bool ev_get(ev_t self, ev_type_t *ptype)
+bool ev_get(ev_t self, ev_msg_t *msg, __UNUSED u32_t timeout_ms)
 {
-  assert(self);
+  assert(self && msg);
 
 #if (EV_USE_THREADS)
-  // Wait for semaphore (blocking mode)
-  semph_wait(self->sem);
-  *ptype = self->type;
-  self->active = false;
+  // Drop stale signal first, post made after this point sets it again
+  semph_wait(self->sem, 0);
+  if (!pop(self, msg)) {
+    if (!timeout_ms) return false;
+    u64_t end = tmr_now_us() + (u64_t)timeout_ms * 1000;
+    // Wait for semaphore, cell is published before semaphore is posted.
+    // Signal may come from producer of later position while the oldest
+    // one is still filled, then the next signal is waited for
+    do {
+      u32_t ms = timeout_ms;
+      if (timeout_ms != EV_FOREVER) {
+        u64_t now = tmr_now_us();
+        if (now >= end) return false;
+        ms = (u32_t)((end - now + 999) / 1000);
+      }
+      if (!semph_wait(self->sem, ms)) return false;
+    } while (!pop(self, msg));
+  }
+  // Keep descriptor readable while events remain
+  if (pending(self)) semph_post(self->sem);
   return true;
 #else
-  // Check activity without blocking
-  if (self->active) {
-    *ptype = self->type;
-    self->active = false;
-    return true;
-  }
-  return false;
+  return pop(self, msg);
+#endif
+}
+
+/**
+ * Wake consumer without event.
+ */
+void ev_wake(ev_t self)
+{
+  assert(self);
+#if (EV_USE_THREADS)
+  semph_post(self->sem);
+#endif
+}
+
+/**
+ * Get pollable descriptor of event.
+ */
+fd_t ev_get_fd(ev_t self)
+{
+  assert(self);
+#if (EV_USE_THREADS)
+  return semph_get_fd(self->sem);
+#else
+  return -1;
 #endif
 }
+
+/**
+ * Get number of lost events.
+ */
+u32_t ev_get_lost(ev_t self)
+{
+  assert(self);
+  return atomic_load_explicit(&self->lost, memory_order_relaxed);
+}
+
+// Private function definitions
+
+/**
+ * Take oldest event from queue.
+ *
+ * @param self pointer to instance
+ * @param msg pointer to store event
+ * @return true if event was taken, false if queue is empty
+ */
+static bool pop(ev_t self, ev_msg_t *msg)
+{
+  cell_t *cell = &self->cell[self->deq & EV_MASK];
+  u32_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+
+  if (seq != self->deq + 1) return false;
+  *msg = cell->msg;
+  atomic_store_explicit(&cell->seq, self->deq + EV_QUEUE_DEPTH,
+                        memory_order_release);
+  self->deq++;
+  return true;
+}
+
+/**
+ * Check if queue holds published event.
+ *
+ * @param self pointer to instance
+ * @return true if next event is ready
+ */
+static __UNUSED bool pending(ev_t self)
+{
+  cell_t *cell = &self->cell[self->deq & EV_MASK];
+  return atomic_load_explicit(&cell->seq, memory_order_acquire) ==
+         self->deq + 1;
+}
@@ -0,0 +1,189 @@
+/**
+ * @file goose.c
+ * @author Ilia Proniashin, msg@proglyk.ru
+ * @date 18-October-2026
+ *
+ * GOOSE fast path implementation (libiec61850 GoosePublisher).
+ */
+
+#include "goose.h"
+
+#if (S2M_USE_GOOSE)
+
+#if (!S2M_USE_LIBIEC)
+#error "Macro 'S2M_USE_LIBIEC' must be enabled if you're using goose.c"
+#endif
+
+#if (S2M_REDUCED)
+#error "GOOSE fast path needs subscriptions, disable 'S2M_REDUCED'"
+#endif
+
+#include "alloc.h"
+#include "mms_if.h"
+#include "port_tmr.h"
+#include "goose_publisher.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * Internal GOOSE publisher object structure.
+ */
+struct goose_s {
+  GoosePublisher pub;             // libiec61850 publisher
+  LinkedList vals;                // Dataset values (mag, t per subscription)
+  MmsValue *mag[SER_NUM_SUBS];    // Value members (NULL if not published)
+  MmsValue *t[SER_NUM_SUBS];      // Timestamp members
+  s16_t last[SER_NUM_SUBS];       // Last published values
+  bool valid;                     // Values were published at least once
+  goose_stats_t stats;            // Statistics
+};
+
+STATIC_DECLARE(GOOSE, struct goose_s);
+
+// Private function declarations
+
+static bool update(goose_t, const frame_view_t *);
+
+// Public interface function definitions
+
+// Basic functions
+
+/**
+ * Constructor.
+ */
+goose_t goose_new(const goose_cfg_t *cfg)
+{
+  CommParameters prm;
+  assert(cfg && cfg->iface && cfg->gocb_ref && cfg->dataset_ref);
+
+  ALLOC(GOOSE, struct goose_s, self, return NULL);
+
+  prm.appId = cfg->appid;
+  prm.vlanId = cfg->vlan_id;
+  prm.vlanPriority = cfg->vlan_prio;
+  memcpy(prm.dstAddress, cfg->dst_mac, sizeof(prm.dstAddress));
+
+  self->pub = GoosePublisher_create(&prm, cfg->iface);
+  if (!self->pub) {
+    printf("[goose_new] Can't open interface '%s'\n", cfg->iface);
+    goto error_0;
+  }
+  GoosePublisher_setGoCbRef(self->pub, (char *)cfg->gocb_ref);
+  GoosePublisher_setDataSetRef(self->pub, (char *)cfg->dataset_ref);
+  GoosePublisher_setGoID(self->pub,
+                         (char *)(cfg->go_id ? cfg->go_id : cfg->gocb_ref));
+  GoosePublisher_setConfRev(self->pub, cfg->conf_rev);
+  GoosePublisher_setTimeAllowedToLive(self->pub, cfg->ttl_ms);
+
+  // Dataset members are created once and updated in place
+  self->vals = LinkedList_create();
+  if (!self->vals) goto error_1;
+  for (u32_t i=0; i<SER_NUM_SUBS; i++) {
+    if (!(cfg->subs & (1U << i))) continue;
+    self->mag[i] = MmsValue_newIntegerFromInt32(0);
+    self->t[i] = MmsValue_newUtcTime(0);
+    if (!self->mag[i] || !self->t[i]) goto error_2;
+    LinkedList_add(self->vals, self->mag[i]);
+    LinkedList_add(self->vals, self->t[i]);
+  }
+  return self;
+
+error_2:
+  for (u32_t i=0; i<SER_NUM_SUBS; i++) {
+    if (self->mag[i]) MmsValue_delete(self->mag[i]);
+    if (self->t[i]) MmsValue_delete(self->t[i]);
+  }
+  LinkedList_destroyStatic(self->vals);
+error_1:
+  GoosePublisher_destroy(self->pub);
+error_0:
+  FREE(GOOSE, self);
+  return NULL;
+}
+
+/**
+ * Destructor.
+ */
+void goose_destroy(goose_t self)
+{
+  assert(self);
+  GoosePublisher_destroy(self->pub);
+  LinkedList_destroyDeep(self->vals,
+                         (LinkedListValueDeleteFunction)MmsValue_delete);
+  FREE(GOOSE, self);
+}
+
+// Publishing
+
+/**
+ * Publish subscription values.
+ */
+void goose_publish(goose_t self, const frame_view_t *frm, u64_t rx_us)
+{
+  assert(self && frm);
+
+  if (update(self, frm)) {
+    GoosePublisher_increaseStNum(self->pub);
+    self->stats.st_changes++;
+  }
+  if (GoosePublisher_publish(self->pub, self->vals) < 0) {
+    self->stats.errors++;
+    return;
+  }
+
+  u32_t lat = (u32_t)(tmr_now_us() - rx_us);
+  self->stats.sent++;
+  self->stats.lat_last_us = lat;
+  self->stats.lat_sum_us += lat;
+  if (lat > self->stats.lat_max_us) self->stats.lat_max_us = lat;
+}
+
+// Helper functions
+
+/**
+ * Get publisher statistics.
+ */
+void goose_get_stats(goose_t self, goose_stats_t *stats)
+{
+  assert(self && stats);
+  *stats = self->stats;
+}
+
+// Private function definitions
+
+/**
+ * Update dataset members.
+ * Only published values are decoded from frame, timestamps are re-encoded
+ * only for values that changed.
+ *
+ * @param self pointer to instance
+ * @param frm view over received frame
+ * @return true if any published value changed
+ */
+static bool update(goose_t self, const frame_view_t *frm)
+{
+  u8_t raw[8];
+  u32_t t[2];
+  bool changed = false;
+
+  for (u32_t i=0; i<SER_NUM_SUBS; i++) {
+    if (!self->mag[i]) continue;
+    s16_t mag = frame_mag(frm, i);
+    if (self->valid && (mag == self->last[i])) continue;
+    MmsValue_setInt32(self->mag[i], mag);
+    frame_ts(frm, i, t);
+    mms_if_encode_utc(raw, t, false);   // Wire time, ms
+    MmsValue_setUtcTimeByBuffer(self->t[i], raw);
+    self->last[i] = mag;
+    changed = true;
+  }
+  // The very first message starts with initial state number
+  if (!self->valid) {
+    self->valid = true;
+    return false;
+  }
+  return changed;
+}
+
+#endif
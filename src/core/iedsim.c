@@ -0,0 +1,308 @@
+/**
+ * @file iedsim.c
+ * @author Ilia Proniashin, msg@proglyk.ru
+ * @date 18-October-2026
+ *
+ * In-memory IED server stand-in implementation.
+ */
+
+#include "iedsim.h"
+
+#if (!S2M_USE_LIBIEC)
+
+#include "alloc.h"
+#include "byteops.h"
+#include "port_tmr.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * Internal IED server stand-in structure.
+ */
+struct iedsim_s {
+  atomic_flag lock;         // Data model lock
+  atomic_uint latency_us;   // Injected update latency, us
+  atomic_uint updates;      // Total number of updates
+  DataAttribute *attrs;     // Registered attributes
+};
+
+STATIC_DECLARE(IEDSIM, struct iedsim_s);
+
+// Private function declarations
+
+static MmsValue *new_value(MmsType);
+static void lock(IedServer);
+static void unlock(IedServer);
+
+// Public interface function definitions
+
+// Basic functions
+
+/**
+ * Constructor.
+ */
+IedServer iedsim_new(void)
+{
+  ALLOC(IEDSIM, struct iedsim_s, self, return NULL);
+  atomic_flag_clear(&self->lock);
+  return self;
+}
+
+/**
+ * Destructor.
+ */
+void iedsim_destroy(IedServer self)
+{
+  assert(self);
+  while (self->attrs) {
+    DataAttribute *attr = self->attrs;
+    self->attrs = attr->next;
+    free((void *)attr->ref);
+    free(attr);
+  }
+  FREE(IEDSIM, self);
+}
+
+// Data model
+
+/**
+ * Register named attribute.
+ */
+DataAttribute *iedsim_add(IedServer self, const char *ref)
+{
+  assert(self && ref);
+  DataAttribute *attr = calloc(1, sizeof(DataAttribute));
+  if (!attr) return NULL;
+  attr->ref = strdup(ref);
+  if (!attr->ref) {
+    free(attr);
+    return NULL;
+  }
+  lock(self);
+  attr->next = self->attrs;
+  self->attrs = attr;
+  unlock(self);
+  return attr;
+}
+
+/**
+ * Find registered attribute.
+ */
+DataAttribute *iedsim_find(IedServer self, const char *ref)
+{
+  DataAttribute *attr;
+  assert(self && ref);
+  lock(self);
+  for (attr = self->attrs; attr; attr = attr->next) {
+    if (!strcmp(attr->ref, ref)) break;
+  }
+  unlock(self);
+  return attr;
+}
+
+/**
+ * Emulate client write.
+ */
+bool iedsim_write(IedServer self, DataAttribute *attr, const MmsValue *value)
+{
+  MmsValue tmp;
+  assert(self && attr && value);
+
+  tmp = *value;
+  if (attr->wr &&
+      (attr->wr(attr, &tmp, NULL, attr->wr_prm) != DATA_ACCESS_ERROR_SUCCESS)) {
+    return false;
+  }
+  IedServer_updateAttributeValue(self, attr, &tmp);
+  return true;
+}
+
+// Measurements
+
+/**
+ * Set injected latency.
+ */
+void iedsim_set_latency(IedServer self, u32_t us)
+{
+  assert(self);
+  atomic_store(&self->latency_us, us);
+}
+
+/**
+ * Get total number of attribute updates.
+ */
+u32_t iedsim_get_updates(IedServer self)
+{
+  assert(self);
+  return atomic_load(&self->updates);
+}
+
+/**
+ * Get number of updates of attribute.
+ */
+u32_t iedsim_get_attr_updates(DataAttribute *attr)
+{
+  assert(attr);
+  return atomic_load(&attr->updates);
+}
+
+// Emulated libiec61850 API
+
+MmsValue *MmsValue_newIntegerFromInt32(s32_t value)
+{
+  MmsValue *self = new_value(MMS_INTEGER);
+  if (self) self->v.i = value;
+  return self;
+}
+
+MmsValue *MmsValue_newFloat(f32_t value)
+{
+  MmsValue *self = new_value(MMS_FLOAT);
+  if (self) self->v.f = value;
+  return self;
+}
+
+MmsValue *MmsValue_newBitString(int size)
+{
+  MmsValue *self = new_value(MMS_BIT_STRING);
+  if (self) self->size = (u32_t)size;
+  return self;
+}
+
+MmsValue *MmsValue_newUtcTime(uint32_t timeval)
+{
+  MmsValue *self = new_value(MMS_UTC_TIME);
+  if (self) I_TO_PB(self->v.utc, timeval);
+  return self;
+}
+
+MmsValue *MmsValue_newUtcTimeByTimestamp(u32_t *timestamp)
+{
+  return MmsValue_newUtcTime(timestamp ? timestamp[0] : 0);
+}
+
+void MmsValue_delete(MmsValue *self)
+{
+  free(self);
+}
+
+void MmsValue_setBitStringBit(MmsValue *self, int pos, bool value)
+{
+  assert(self && (pos >= 0) && (pos < 32));
+  if (value) self->v.u |= (1U << pos);
+  else self->v.u &= ~(1U << pos);
+}
+
+void MmsValue_setInt32(MmsValue *self, s32_t value)
+{
+  assert(self);
+  self->v.i = value;
+}
+
+void MmsValue_setUtcTimeByBuffer(MmsValue *self, const uint8_t *buf)
+{
+  assert(self && buf);
+  memcpy(self->v.utc, buf, sizeof(self->v.utc));
+}
+
+MmsType MmsValue_getType(const MmsValue *self)
+{
+  assert(self);
+  return self->type;
+}
+
+s32_t MmsValue_toInt32(const MmsValue *self)
+{
+  assert(self);
+  return self->v.i;
+}
+
+u32_t MmsValue_toUint32(const MmsValue *self)
+{
+  assert(self);
+  return self->v.u;
+}
+
+f32_t MmsValue_toFloat(const MmsValue *self)
+{
+  assert(self);
+  return self->v.f;
+}
+
+bool MmsValue_getBoolean(const MmsValue *self)
+{
+  assert(self);
+  return self->v.b;
+}
+
+#if (S2M_USE_OLD_LIBIEC_API)
+bool IedServer_updateAttributeValue(IedServer self, DataAttribute *attr,
+                                    MmsValue *value)
+#else
+void IedServer_updateAttributeValue(IedServer self, DataAttribute *attr,
+                                    MmsValue *value)
+#endif
+{
+  assert(self && attr && value);
+  u32_t lat = atomic_load_explicit(&self->latency_us, memory_order_relaxed);
+
+  lock(self);
+  attr->val = *value;
+  attr->mmsValue = &attr->val;
+  // Emulate busy server: data model stays locked for injected time
+  if (lat) {
+    u64_t end = tmr_now_us() + lat;
+    while (tmr_now_us() < end) {}
+  }
+  unlock(self);
+
+  atomic_fetch_add_explicit(&attr->updates, 1, memory_order_relaxed);
+  atomic_fetch_add_explicit(&self->updates, 1, memory_order_relaxed);
+#if (S2M_USE_OLD_LIBIEC_API)
+  return true;
+#endif
+}
+
+void IedServer_handleWriteAccess(IedServer self, DataAttribute *attr,
+                                 WriteAccessHandler handler, void *prm)
+{
+  assert(self && attr);
+  lock(self);
+  // As libiec61850: parameter is kept from the first registration
+  if (!attr->wr) attr->wr_prm = prm;
+  attr->wr = handler;
+  unlock(self);
+}
+
+// Private function definitions
+
+/**
+ * Allocate value of given type.
+ */
+static MmsValue *new_value(MmsType type)
+{
+  MmsValue *self = calloc(1, sizeof(MmsValue));
+  if (self) self->type = type;
+  return self;
+}
+
+/**
+ * Take data model lock.
+ */
+static void lock(IedServer self)
+{
+  while (atomic_flag_test_and_set_explicit(&self->lock,
+                                           memory_order_acquire)) {}
+}
+
+/**
+ * Release data model lock.
+ */
+static void unlock(IedServer self)
+{
+  atomic_flag_clear_explicit(&self->lock, memory_order_release);
+}
+
+#endif
@@ -0,0 +1,92 @@
+/**
+ * @file answ.h
+ * @author Ilia Proniashin, msg@proglyk.ru
+ * @date 18-October-2026
+ *
+ * Precomputed answer interface.
+ * Keeps answer block of SLAVE reply encoded (big-endian) and up to date:
+ * values are re-encoded by write handlers of answer attributes when client
+ * writes them, so reply is built by copying the block.
+ */
+
+#ifndef SER2MMS_ANSW_H
+#define SER2MMS_ANSW_H
+
+#include "ser2mms_conf.h"
+#include "ser.h"
+#include "mms_if.h"
+#include "port_types.h"
+
+/** Use static allocation. */
+#define ANSW_USE_STATIC (0)
+
+/** Size of encoded answer block, bytes. */
+#define ANSW_BLOCK_SIZE (SER_ANSW_SIZE * 2)
+
+/** Pointer type to answer object. */
+typedef struct answ_s *answ_t;
+
+// Public interface function declarations
+
+// Basic functions
+
+/**
+ * Answer object constructor.
+ * Encodes current values of attributes and installs their write handlers.
+ * Values out of int16 range are saturated, client writes of such values
+ * are rejected.
+ *
+ * @param ied IED server instance
+ * @param attrs answer attributes in reply order
+ * @param num number of attributes (up to SER_ANSW_SIZE)
+ * @return pointer to created instance or NULL on error
+ */
+answ_t answ_new(void *ied, DataAttribute *const *attrs, u32_t num);
+
+/**
+ * Answer object destructor.
+ * Removes write handlers of answer attributes.
+ *
+ * @param self pointer to instance
+ */
+void answ_destroy(answ_t self);
+
+// Access to answer
+
+/**
+ * Set answer value.
+ * For values changed locally, not by client write.
+ *
+ * @param self pointer to instance
+ * @param idx value index
+ * @param value new value
+ */
+void answ_set(answ_t self, u32_t idx, s16_t value);
+
+/**
+ * Copy encoded answer block.
+ *
+ * @param self pointer to instance
+ * @param buf buffer to place block (ANSW_BLOCK_SIZE bytes at most)
+ * @return number of bytes copied
+ */
+u32_t answ_read(answ_t self, u8_t *buf);
+
+/**
+ * Get number of answer values.
+ *
+ * @param self pointer to instance
+ * @return number of values
+ */
+u32_t answ_get_num(answ_t self);
+
+/**
+ * Get answer version.
+ * Version is changed on every update of answer block.
+ *
+ * @param self pointer to instance
+ * @return current version (even number)
+ */
+u32_t answ_get_ver(answ_t self);
+
+#endif
@@ -4,8 +4,10 @@
  * @date 30-September-2025
  * 
  * Event mechanism interface.
- * Provides simple event mechanism for synchronization between
- * system components with multithreading support via semaphores.
+ * Provides bounded lock-free queue of typed events with payload for
+ * synchronization between system components. Any number of producers
+ * (timer, receive path, control API, ISR) may post, one consumer gets;
+ * with multithreading support consumer blocks on semaphore.
  */
 
 #ifndef SER2MMS_EVENT_H
@@ -18,8 +20,14 @@
 /** Memory allocation. */
 #define EVENT_USE_STATIC (0)
 
-/** Thread usage. */
-#define EV_USE_THREADS (0)
+/** Thread usage (blocking wait on port semaphore). */
+#define EV_USE_THREADS (S2M_USE_THREADS)
+
+/** Queue depth, events (power of 2). */
+#define EV_QUEUE_DEPTH (16)
+
+/** Wait without timeout. */
+#define EV_FOREVER (0xffffffffU)
 
 /** Pointer type to event object. */
 typedef struct event_s *event_t;
@@ -33,13 +41,23 @@ typedef event_t ev_t;
 typedef enum {
   EV_NONE,  // No event
   EV_RCVD,  // Data receive event
-  EV_EXEC,  // Execution event
-  EV_SENT   // Data send event
+  EV_EXEC,  // Execution event (payload - command)
+  EV_SENT,  // Data send event
+  EV_RESP,  // Reply to request accepted (POLL mode)
+  EV_ADDR   // Address change event (payload - new address)
 } ev_type_t;
 
+/**
+ * Event with payload.
+ */
+typedef struct {
+  ev_type_t type;   // Event type
+  u32_t arg;        // Payload, meaning depends on type
+} ev_msg_t;
+
 /**
  * Event object constructor.
- * Creates a new event instance with semaphore initialization (if threads are used).
+ * Creates a new event queue with semaphore initialization (if threads are used).
  * 
  * @return pointer to event instance on success, NULL on allocation error
  */
@@ -55,23 +73,55 @@ void ev_destroy(ev_t self);
 
 /**
  * Post event.
- * Sets event type and signals its occurrence.
- * In multithreaded mode releases semaphore.
+ * Puts event to queue and signals its occurrence. Lock-free, may be called
+ * concurrently from several threads or from ISR.
  * 
  * @param self pointer to instance
  * @param type event type to post
+ * @param arg event payload
+ * @return true if event was queued, false if queue is full (event is counted
+ * as lost)
  */
-void ev_post(ev_t self, ev_type_t type);
+bool ev_post(ev_t self, ev_type_t type, u32_t arg);
 
 /**
  * Get event.
- * Retrieves pending event. In multithreaded mode blocks until event appears,
- * in single-threaded mode returns immediately.
+ * Takes oldest pending event. In multithreaded mode blocks until event
+ * appears or timeout expires, in single-threaded mode returns immediately.
+ * Must be called from one thread only.
+ * 
+ * @param self pointer to instance
+ * @param msg pointer to store received event
+ * @param timeout_ms wait time, ms (0 - don't block, EV_FOREVER - no timeout)
+ * @return true if event was retrieved, false if no events pending
+ */
+bool ev_get(ev_t self, ev_msg_t *msg, u32_t timeout_ms);
+
+/**
+ * Wake consumer without event.
+ * Interrupts blocked ev_get() (and wait on descriptor), ev_get() returns
+ * false if queue is empty. Never lost, even when queue is full.
+ * 
+ * @param self pointer to instance
+ */
+void ev_wake(ev_t self);
+
+/**
+ * Get pollable descriptor of event.
+ * Descriptor is readable while queue holds events, so it can be waited
+ * together with other descriptors (select/poll). It is not consumed.
+ * 
+ * @param self pointer to instance
+ * @return descriptor or -1 if not supported by port
+ */
+fd_t ev_get_fd(ev_t self);
+
+/**
+ * Get number of events lost because queue was full.
  * 
  * @param self pointer to instance
- * @param ptype pointer to store received event type
- * @return true if event was retrieved, false if no events pending (single-threaded mode only)
+ * @return number of lost events
  */
-bool ev_get(ev_t self, ev_type_t *ptype);
+u32_t ev_get_lost(ev_t self);
 
 #endif
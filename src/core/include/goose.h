@@ -0,0 +1,94 @@
+/**
+ * @file goose.h
+ * @author Ilia Proniashin, msg@proglyk.ru
+ * @date 18-October-2026
+ *
+ * GOOSE fast path interface.
+ * Publishes selected subscription values as GOOSE messages right after
+ * frame is decoded, before they are written to data model. Dataset of
+ * control block holds pair of members for each selected subscription:
+ * INT32 value and Timestamp.
+ */
+
+#ifndef SER2MMS_GOOSE_H
+#define SER2MMS_GOOSE_H
+
+#include "ser2mms_conf.h"
+#include "ser.h"
+#include "port_types.h"
+
+/** Use static allocation. */
+#define GOOSE_USE_STATIC (0)
+
+/** Pointer type to GOOSE publisher object. */
+typedef struct goose_s *goose_t;
+
+/** GOOSE publisher settings. */
+typedef struct {
+  const char *iface;        // Network interface, e.g. "eth0"
+  u16_t appid;              // Application ID
+  u8_t dst_mac[6];          // Destination multicast address
+  u16_t vlan_id;            // VLAN ID
+  u8_t vlan_prio;           // VLAN priority
+  const char *gocb_ref;     // Control block, e.g. "IEDNAMEUPG/LLN0$GO$gcb01"
+  const char *dataset_ref;  // Dataset, e.g. "IEDNAMEUPG/LLN0$dsSubs"
+  const char *go_id;        // GoID or NULL to use control block reference
+  u32_t conf_rev;           // Configuration revision
+  u32_t ttl_ms;             // Time allowed to live, ms
+  u32_t subs;               // Bitmask of published subscription indices
+} goose_cfg_t;
+
+/** GOOSE publisher statistics. */
+typedef struct {
+  u32_t sent;         // Messages sent
+  u32_t errors;       // Send errors
+  u32_t st_changes;   // State number increments
+  u32_t lat_last_us;  // Frame received -> message sent, last, us
+  u32_t lat_max_us;   // Same, maximum, us
+  u64_t lat_sum_us;   // Same, sum over all sent messages, us
+} goose_stats_t;
+
+// Public interface function declarations
+
+// Basic functions
+
+/**
+ * GOOSE publisher constructor.
+ * Opens network interface and prepares dataset values.
+ *
+ * @param cfg publisher settings (strings must outlive the object)
+ * @return pointer to created instance or NULL on error
+ */
+goose_t goose_new(const goose_cfg_t *cfg);
+
+/**
+ * GOOSE publisher destructor.
+ *
+ * @param self pointer to instance
+ */
+void goose_destroy(goose_t self);
+
+// Publishing
+
+/**
+ * Publish subscription values.
+ * State number is increased only if any published value changed,
+ * otherwise message is a retransmission with next sequence number.
+ *
+ * @param self pointer to instance
+ * @param frm view over received frame
+ * @param rx_us time of frame reception (tmr_now_us) for latency statistics
+ */
+void goose_publish(goose_t self, const frame_view_t *frm, u64_t rx_us);
+
+// Helper functions
+
+/**
+ * Get publisher statistics.
+ *
+ * @param self pointer to instance
+ * @param stats pointer to place statistics
+ */
+void goose_get_stats(goose_t self, goose_stats_t *stats);
+
+#endif
@@ -0,0 +1,190 @@
+/**
+ * @file iedsim.h
+ * @author Ilia Proniashin, msg@proglyk.ru
+ * @date 18-October-2026
+ *
+ * In-memory IED server stand-in.
+ * Used instead of libiec61850 when S2M_USE_LIBIEC is 0. Provides the part
+ * of libiec61850 API used by mms_if with typed values stored in attributes,
+ * update counters, optional latency injection and registry of named
+ * attributes, so the whole frame -> model path can be benchmarked and
+ * soak-tested without the library.
+ */
+
+#ifndef SER2MMS_IEDSIM_H
+#define SER2MMS_IEDSIM_H
+
+#include "ser2mms_conf.h"
+#include "port_types.h"
+#include <stdatomic.h>
+#include <stdbool.h>
+
+#if (!S2M_USE_LIBIEC)
+
+/** Use static allocation. */
+#define IEDSIM_USE_STATIC (0)
+
+// Type declarations
+
+/** Value types (names of libiec61850). */
+typedef enum {
+  MMS_DATA_ACCESS_ERROR = -1,
+  MMS_ARRAY = 0,
+  MMS_STRUCTURE,
+  MMS_BOOLEAN,
+  MMS_BIT_STRING,
+  MMS_INTEGER,
+  MMS_UNSIGNED,
+  MMS_FLOAT,
+  MMS_UTC_TIME = 12
+} MmsType;
+
+/** Result of write access handler (subset of libiec61850). */
+typedef enum {
+  DATA_ACCESS_ERROR_SUCCESS = 0,
+  DATA_ACCESS_ERROR_TYPE_INCONSISTENT = 7,
+  DATA_ACCESS_ERROR_OBJECT_VALUE_INVALID = 11
+} MmsDataAccessError;
+
+/** Typed value. */
+typedef struct iedsim_val_s {
+  MmsType type;     // Value type
+  u32_t size;       // Number of bits (bit string)
+  union {
+    s32_t i;        // MMS_INTEGER
+    u32_t u;        // MMS_UNSIGNED, MMS_BIT_STRING
+    f32_t f;        // MMS_FLOAT
+    bool b;         // MMS_BOOLEAN
+    u8_t utc[8];    // MMS_UTC_TIME
+  } v;
+} MmsValue;
+
+/** Client connection (not used). */
+typedef struct iedsim_conn_s *ClientConnection;
+
+/** Data attribute, zero-initialized instance is valid. */
+typedef struct iedsim_attr_s DataAttribute;
+
+/** Write access handler (libiec61850 signature). */
+typedef MmsDataAccessError (*WriteAccessHandler)(DataAttribute *, MmsValue *,
+                                                 ClientConnection, void *);
+
+struct iedsim_attr_s {
+  MmsValue *mmsValue;           // Current value, NULL until first update
+  MmsValue val;                 // Value storage
+  atomic_uint updates;          // Number of updates
+  WriteAccessHandler wr;        // Write access handler
+  void *wr_prm;                 // Handler parameter
+  const char *ref;              // Object reference (registered attributes)
+  struct iedsim_attr_s *next;   // Next registered attribute
+};
+
+/** Pointer type to IED server stand-in. */
+typedef struct iedsim_s *IedServer;
+
+// Public interface function declarations
+
+// Basic functions
+
+/**
+ * IED server stand-in constructor.
+ *
+ * @return pointer to created instance or NULL on allocation error
+ */
+IedServer iedsim_new(void);
+
+/**
+ * IED server stand-in destructor.
+ * Frees registered attributes.
+ *
+ * @param self pointer to instance
+ */
+void iedsim_destroy(IedServer self);
+
+// Data model
+
+/**
+ * Register named attribute.
+ *
+ * @param self pointer to instance
+ * @param ref object reference, e.g. "IEDNAMEUPG/GGIO0.HV.mag.f" (copied)
+ * @return pointer to attribute or NULL on allocation error
+ */
+DataAttribute *iedsim_add(IedServer self, const char *ref);
+
+/**
+ * Find registered attribute.
+ *
+ * @param self pointer to instance
+ * @param ref object reference
+ * @return pointer to attribute or NULL if not found
+ */
+DataAttribute *iedsim_find(IedServer self, const char *ref);
+
+/**
+ * Emulate client write.
+ * Calls write access handler of attribute and stores value if accepted.
+ *
+ * @param self pointer to instance
+ * @param attr attribute
+ * @param value new value
+ * @return true if write was accepted
+ */
+bool iedsim_write(IedServer self, DataAttribute *attr, const MmsValue *value);
+
+// Measurements
+
+/**
+ * Set latency injected into every attribute update.
+ * Update holds data model lock for this time, like a busy server would.
+ *
+ * @param self pointer to instance
+ * @param us latency, us (0 - off)
+ */
+void iedsim_set_latency(IedServer self, u32_t us);
+
+/**
+ * Get total number of attribute updates.
+ *
+ * @param self pointer to instance
+ * @return number of updates
+ */
+u32_t iedsim_get_updates(IedServer self);
+
+/**
+ * Get number of updates of attribute.
+ *
+ * @param attr attribute
+ * @return number of updates
+ */
+u32_t iedsim_get_attr_updates(DataAttribute *attr);
+
+// Emulated libiec61850 API
+
+MmsValue *MmsValue_newIntegerFromInt32(s32_t value);
+MmsValue *MmsValue_newFloat(f32_t value);
+MmsValue *MmsValue_newBitString(int size);
+MmsValue *MmsValue_newUtcTime(uint32_t timeval);
+MmsValue *MmsValue_newUtcTimeByTimestamp(u32_t *timestamp);
+void MmsValue_delete(MmsValue *self);
+void MmsValue_setBitStringBit(MmsValue *self, int pos, bool value);
+void MmsValue_setInt32(MmsValue *self, s32_t value);
+void MmsValue_setUtcTimeByBuffer(MmsValue *self, const uint8_t *buf);
+MmsType MmsValue_getType(const MmsValue *self);
+s32_t MmsValue_toInt32(const MmsValue *self);
+u32_t MmsValue_toUint32(const MmsValue *self);
+f32_t MmsValue_toFloat(const MmsValue *self);
+bool MmsValue_getBoolean(const MmsValue *self);
+#if (S2M_USE_OLD_LIBIEC_API)
+bool IedServer_updateAttributeValue(IedServer self, DataAttribute *attr,
+                                    MmsValue *value);
+#else
+void IedServer_updateAttributeValue(IedServer self, DataAttribute *attr,
+                                    MmsValue *value);
+#endif
+void IedServer_handleWriteAccess(IedServer self, DataAttribute *attr,
+                                 WriteAccessHandler handler, void *prm);
+
+#endif // S2M_USE_LIBIEC
+
+#endif
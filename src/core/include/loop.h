@@ -0,0 +1,79 @@
+/**
+ * @file loop.h
+ * @author Ilia Proniashin, msg@proglyk.ru
+ * @date 18-October-2026
+ *
+ * Session scheduler interface.
+ * Drives many transport sessions from one thread: waits for descriptors
+ * of all of them at once and processes only ready ones and ones whose
+ * deadline (frame gap, reply timeout) has come. Sessions keep their state
+ * in coroutines (see pt.h), so no thread is spent per line.
+ */
+
+#ifndef SER2MMS_LOOP_H
+#define SER2MMS_LOOP_H
+
+#include "ser2mms_conf.h"
+#include "transp.h"
+#include "port_types.h"
+
+/** Use static allocation. */
+#define LOOP_USE_STATIC (0)
+
+/** Maximum number of sessions. */
+#define LOOP_MAX_SESSIONS S2M_LOOP_MAX_SESSIONS
+
+/** Pointer type to scheduler object. */
+typedef struct loop_s *loop_t;
+
+// Public interface function declarations
+
+// Basic functions
+
+/**
+ * Scheduler object constructor.
+ *
+ * @return pointer to created instance or NULL on error
+ */
+loop_t loop_new(void);
+
+/**
+ * Scheduler object destructor.
+ * Sessions are not destroyed.
+ *
+ * @param self pointer to instance
+ */
+void loop_destroy(loop_t self);
+
+/**
+ * Add session.
+ * Session must not be polled by its own thread.
+ *
+ * @param self pointer to instance
+ * @param tp transport layer of session
+ * @return 0 on success, -1 if there's no room or descriptor can't be added
+ */
+s32_t loop_add(loop_t self, transp_t *tp);
+
+/**
+ * Remove session.
+ * Its descriptors are no longer waited for, session may be destroyed or
+ * added again.
+ *
+ * @param self pointer to instance
+ * @param tp transport layer of session
+ * @return 0 on success, -1 if session isn't added
+ */
+s32_t loop_remove(loop_t self, transp_t *tp);
+
+/**
+ * Run one pass: wait for ready sessions or the nearest deadline and
+ * process them.
+ *
+ * @param self pointer to instance
+ * @param wait_ms maximum time to wait, ms (-1 - until something happens)
+ * @return number of processed sessions, -1 on error
+ */
+s32_t loop_run(loop_t self, s32_t wait_ms);
+
+#endif
@@ -0,0 +1,167 @@
+/**
+ * @file map.h
+ * @author Ilia Proniashin, msg@proglyk.ru
+ * @date 18-October-2026
+ *
+ * Attribute mapping table interface.
+ * Binds every received value (dataset, page, index or subscription index)
+ * to IEC 61850 data attributes with scaling. Entries are kept in a flat
+ * array, so values of a frame are dispatched by index without lookup.
+ */
+
+#ifndef SER2MMS_MAP_H
+#define SER2MMS_MAP_H
+
+#include "ser2mms_conf.h"
+#include "ser.h"
+#include "mms_if.h"
+#include "port_types.h"
+#include <stdbool.h>
+
+/** Use static allocation. */
+#define MAP_USE_STATIC (0)
+
+/** Number of subscription entries. */
+#if (S2M_REDUCED)
+#define MAP_NUM_SUBS (0)
+#else
+#define MAP_NUM_SUBS SER_NUM_SUBS
+#endif
+
+/** Number of pages per dataset. */
+#define MAP_PAGES_PER_DS (SER_MAX_PAGE_IDX - SER_MIN_PAGE_IDX + 1)
+
+/** Number of page entries. */
+#define MAP_NUM_PAGE_ENTS \
+  ((SER_MAX_DS_IDX - SER_MIN_DS_IDX + 1) * MAP_PAGES_PER_DS * SER_PAGE_SIZE)
+
+/** Total number of entries (pages first, subscriptions after). */
+#define MAP_NUM_ENTS (MAP_NUM_PAGE_ENTS + MAP_NUM_SUBS)
+
+/** Flat index of page value. */
+#define MAP_PAGE_IDX(ds, page, i) \
+  (((((ds) - SER_MIN_DS_IDX) * MAP_PAGES_PER_DS) + \
+    ((page) - SER_MIN_PAGE_IDX)) * SER_PAGE_SIZE + (i))
+
+/** Flat index of subscription value. */
+#define MAP_SUB_IDX(i) (MAP_NUM_PAGE_ENTS + (i))
+
+/** Round scaled value to int32. */
+#define MAP_TO_S32(v) ((s32_t)((v) + (((v) < 0) ? -0.5f : 0.5f)))
+
+/** Pointer type to mapping object. */
+typedef struct map_s *map_t;
+
+/** Mapping entry. */
+typedef struct map_ent_s map_ent_t;
+
+/**
+ * Typed attribute setter.
+ * Converts raw value with entry scale and offset and updates attributes.
+ *
+ * @param ied IED server instance
+ * @param ent mapping entry
+ * @param raw raw value from frame
+ * @param ts pointer to timestamp or NULL to use frame time
+ * @return true if attribute set, false if error occurred
+ */
+typedef bool (*map_set_t)(void *ied, const map_ent_t *ent, s16_t raw,
+                          const u32_t *ts);
+
+/** Mapping entry structure. */
+struct map_ent_s {
+  map_set_t set;        // Typed setter, NULL if value isn't mapped
+  DataAttribute *mag;   // Magnitude attribute
+  DataAttribute *t;     // Timestamp attribute (optional)
+  DataAttribute *q;     // Quality attribute (optional)
+  f32_t scale;          // Scale factor
+  f32_t offset;         // Offset added after scaling
+  f32_t db_abs;         // Absolute deadband (0 - off)
+  f32_t db_pct;         // Deadband in percent of last value (0 - off)
+  u32_t min_ms;         // Minimum update interval, ms (0 - off)
+};
+
+// Public interface function declarations
+
+// Basic functions
+
+/**
+ * Mapping object constructor.
+ * Loads mapping table from text file. Each non-empty line, except ones
+ * starting with '#', describes one value:
+ *   P <ds> <page> <idx> <s32|f32> <scale> <offset> <reference> [filter]
+ *   S <idx> <s32|f32> <scale> <offset> <reference> [filter]
+ * where reference is data object reference, e.g. "IEDNAMEUPG/GGIO0.HV".
+ * Attributes mag.i (s32) or mag.f (f32), t and q are resolved below it.
+ * Optional filter is any of "db=<abs>", "dbp=<percent>", "min=<ms>".
+ *
+ * @param ied IED server instance
+ * @param path path to mapping file
+ * @return pointer to created instance or NULL on error
+ */
+map_t map_new(void *ied, const char *path);
+
+/**
+ * Mapping object constructor for static table.
+ * Uses fully resolved table (e.g. emitted by tools/s2m_gen.py) without
+ * parsing anything. Table isn't copied and must outlive the object.
+ *
+ * @param ied IED server instance
+ * @param tbl table of MAP_NUM_ENTS entries indexed by MAP_PAGE_IDX/MAP_SUB_IDX
+ * @return pointer to created instance or NULL on allocation error
+ */
+map_t map_new_static(void *ied, const map_ent_t *tbl);
+
+/**
+ * Mapping object destructor.
+ *
+ * @param self pointer to instance
+ */
+void map_destroy(map_t self);
+
+// Applying values
+
+/**
+ * Apply page values.
+ * Values of entries with deadband or minimum interval are written only if
+ * they moved out of deadband and interval elapsed since previous update.
+ * Change of external timestamp always passes.
+ *
+ * @param self pointer to instance
+ * @param buf buffer with page data (SER_PAGE_SIZE values)
+ * @param ds dataset index
+ * @param page data page number
+ */
+void map_apply_page(map_t self, const page_prm_t *buf, u8_t ds, u8_t page);
+
+/**
+ * Apply subscription values.
+ *
+ * @param self pointer to instance
+ * @param buf buffer with subscription data (MAP_NUM_SUBS values)
+ */
+void map_apply_subs(map_t self, const sub_prm_t *buf);
+
+/**
+ * Apply single value.
+ *
+ * @param self pointer to instance
+ * @param idx flat index of entry (MAP_PAGE_IDX or MAP_SUB_IDX)
+ * @param raw raw value from frame
+ * @param ts external timestamp or NULL to use frame time
+ */
+void map_apply_point(map_t self, u32_t idx, s16_t raw, const u32_t *ts);
+
+// Typed setters
+
+/**
+ * Setter for attributes with int32 type in mag.
+ */
+bool map_set_s32(void *ied, const map_ent_t *ent, s16_t raw, const u32_t *ts);
+
+/**
+ * Setter for attributes with float32 type in mag.
+ */
+bool map_set_f32(void *ied, const map_ent_t *ent, s16_t raw, const u32_t *ts);
+
+#endif
@@ -20,8 +20,13 @@
 #else
 #include "iec61850_server.h" // TODO "make version switch"
 #endif
+#else
+#include "iedsim.h"
 #endif
 
+/** Number of attributes with write handlers, over all IED servers. */
+#define MMS_IF_WR_SLOTS (16)
+
 // Functional macro declarations
 
 /**
@@ -78,19 +83,62 @@
 
 // Type declarations
 
-#if (!S2M_USE_LIBIEC)
 /**
-* Stub types to emulate libiec61850 internal API.
-* Used when library is unavailable.
+* Write handler.
+* Called from IED server thread when client writes attribute, before new
+* value is stored in data model.
+*
+* @param attr written attribute
+* @param value new value converted to int32
+* @param ctx handler context
+* @return true to accept value, false to reject write
 */
-struct null_s { int null; };
-typedef struct null_s *IedServer;
-typedef struct null_s MmsValue;
-typedef struct null_s DataAttribute;
-#endif //S2M_USE_LIBIEC
+typedef bool (*mms_if_wr_t)(DataAttribute *attr, s32_t value, void *ctx);
+
+/** Write handler registration (storage is owned by caller). */
+typedef struct {
+  mms_if_wr_t cb;   // Handler
+  void *ctx;        // Handler context
+} mms_if_wr_hnd_t;
 
 // Public interface function declarations
 
+/**
+* Take frame timestamp.
+* Must be called once per received frame before attributes are set. All
+* subsequent mms_if_set_attr_t calls with NULL timestamp in the calling
+* thread reuse this value instead of reading the system clock until
+* mms_if_unstamp is called at the end of frame.
+*
+* @param ts_ext: if using frame time taken by another thread (see
+*                mms_if_get_stamp) - pointer of type u32_t *
+*                (epoch seconds, microseconds),
+*                if using system time - NULL
+*/
+void mms_if_stamp(const u32_t *ts_ext);
+
+/**
+* End of frame.
+* Forgets timestamp taken by mms_if_stamp, so mms_if_set_attr_t calls with
+* NULL timestamp outside of frame read the system clock again.
+*/
+void mms_if_unstamp(void);
+
+/**
+* Free resources of calling thread.
+* Cached UtcTime value is kept per thread, so every thread setting
+* timestamps calls it before exit.
+*/
+void mms_if_release(void);
+
+/**
+* Get frame timestamp.
+* Returns timestamp taken by last mms_if_stamp call in the calling thread.
+*
+* @param ts pointer to place timestamp (epoch seconds, microseconds)
+*/
+void mms_if_get_stamp(u32_t *ts);
+
 /**
 * Set INT32 value of target attribute.
 * Uses intermediate MmsValue variable with Integer type to update
@@ -117,14 +165,17 @@ bool mms_if_set_attr_f32(void *ied, DataAttribute *attr, const f32_t value);
 
 /**
 * Set timestamp of target attribute.
-* Uses intermediate MmsValue variable with UtcTime type to update
-* attribute to value addressed by ts_ext. If argument not passed,
-* uses current system time.
+* Uses cached MmsValue variable with UtcTime type to update attribute to
+* value addressed by ts_ext with microsecond precision. If argument not
+* passed, uses timestamp of the frame being processed (see mms_if_stamp).
+* Accuracy is marked as microseconds for frame (system clock) time and as
+* milliseconds for external time, which comes from the wire.
 *
 * @param ied IED server instance
 * @param attr target attribute
-* @param ts_ext: if using external value - pointer of type u32_t *,
-*                if using system time - NULL
+* @param ts_ext: if using external value - pointer of type u32_t *
+*                (epoch seconds, microseconds),
+*                if using frame time - NULL
 * @return true if attribute set, false if error occurred
 */
 bool mms_if_set_attr_t(void *ied, DataAttribute *attr, const u32_t *ts_ext);
@@ -141,4 +192,58 @@ bool mms_if_set_attr_t(void *ied, DataAttribute *attr, const u32_t *ts_ext);
 */
 bool mms_if_set_attr_q(void *ied, DataAttribute *attr, const bool quality);
 
+/**
+* Find attribute by object reference.
+* Looks up data attribute in IED server data model, e.g.
+* "IEDNAMEUPG/GGIO0.HV.mag.f".
+*
+* @param ied IED server instance
+* @param ref attribute object reference
+* @return pointer to attribute if found, NULL otherwise
+*/
+DataAttribute *mms_if_find_attr(void *ied, const char *ref);
+
+/**
+* Get value of attribute as int32.
+* Integer, unsigned, float (rounded) and boolean attributes are supported.
+*
+* @param attr attribute
+* @param value pointer to place value
+* @return true on success, false if attribute type isn't supported
+*/
+bool mms_if_get_attr_s32(DataAttribute *attr, s32_t *value);
+
+/**
+* Install write handler of attribute.
+* Attribute is registered in IED server once, repeated calls only replace
+* registration behind it.
+*
+* @param ied IED server instance
+* @param attr attribute
+* @param hnd handler registration, must stay valid until mms_if_off_write
+* @return true on success, false if writes can't be intercepted
+*/
+bool mms_if_on_write(void *ied, DataAttribute *attr, mms_if_wr_hnd_t *hnd);
+
+/**
+* Remove write handler of attribute.
+* Waits for handler calls in progress. Afterwards registration passed to
+* mms_if_on_write may be freed, writes of attribute are accepted as is.
+*
+* @param ied IED server instance
+* @param attr attribute
+*/
+void mms_if_off_write(void *ied, DataAttribute *attr);
+
+/**
+* Encode timestamp as UtcTime.
+* Seconds, 24-bit fraction of second and time quality (accuracy).
+*
+* @param buf buffer to place 8 bytes of encoded value
+* @param ts timestamp (epoch seconds, microseconds)
+* @param us true if taken from system clock (microsecond accuracy), false
+*           for timestamp received on the wire (millisecond accuracy)
+*/
+void mms_if_encode_utc(u8_t *buf, const u32_t *ts, bool us);
+
 #endif
@@ -0,0 +1,130 @@
+/**
+ * @file pt.h
+ * @author Ilia Proniashin, msg@proglyk.ru
+ * @date 05-November-2025
+ *
+ * Stackless coroutines (protothreads).
+ * Coroutine is a function which keeps only its resume point in 'pt_t',
+ * so any number of them can be driven by one thread. Resume point is the
+ * line number stored by 'switch', therefore local variables are not kept
+ * between calls (keep state in object) and 'switch' can't be used in
+ * coroutine body around waiting macros.
+ */
+
+#ifndef SER2MMS_PT_H
+#define SER2MMS_PT_H
+
+#include "port_types.h"
+#include <stdbool.h>
+
+/** Coroutine is waiting for condition. */
+#define PT_WAITING (0)
+
+/** Coroutine gave up control for one pass. */
+#define PT_YIELDED (1)
+
+/** Coroutine was exited with PT_EXIT. */
+#define PT_EXITED  (2)
+
+/** Coroutine reached its end. */
+#define PT_ENDED   (3)
+
+/**
+ * Coroutine state.
+ */
+typedef struct {
+  u16_t lc;  // Resume point (line number, 0 - beginning)
+} pt_t;
+
+/**
+ * Declare coroutine function.
+ *
+ * @param decl function name and arguments
+ */
+#define PT_THREAD(decl) s32_t decl
+
+/**
+ * Reset coroutine to its beginning.
+ *
+ * @param pt pointer to state
+ */
+#define PT_INIT(pt) ((pt)->lc = 0)
+
+/**
+ * Start of coroutine body.
+ *
+ * @param pt pointer to state
+ */
+#define PT_BEGIN(pt) { __UNUSED bool pt_yield = true; switch ((pt)->lc) { case 0:
+
+/**
+ * End of coroutine body.
+ *
+ * @param pt pointer to state
+ */
+#define PT_END(pt) } pt_yield = false; PT_INIT(pt); return PT_ENDED; }
+
+/**
+ * Wait until condition is true.
+ *
+ * @param pt pointer to state
+ * @param cond condition checked on every call
+ */
+#define PT_WAIT_UNTIL(pt, cond)                 \
+  do {                                          \
+    (pt)->lc = __LINE__; __FALLTHROUGH;         \
+    case __LINE__:                              \
+    if (!(cond)) return PT_WAITING;             \
+  } while (0)
+
+/**
+ * Wait while condition is true.
+ *
+ * @param pt pointer to state
+ * @param cond condition checked on every call
+ */
+#define PT_WAIT_WHILE(pt, cond) PT_WAIT_UNTIL((pt), !(cond))
+
+/**
+ * Give up control for one pass.
+ *
+ * @param pt pointer to state
+ */
+#define PT_YIELD(pt)                            \
+  do {                                          \
+    pt_yield = false;                           \
+    (pt)->lc = __LINE__; __FALLTHROUGH;         \
+    case __LINE__:                              \
+    if (!pt_yield) return PT_YIELDED;           \
+  } while (0)
+
+/**
+ * Restart coroutine from its beginning on the next call.
+ *
+ * @param pt pointer to state
+ */
+#define PT_RESTART(pt)                          \
+  do {                                          \
+    PT_INIT(pt);                                \
+    return PT_WAITING;                          \
+  } while (0)
+
+/**
+ * Exit coroutine, it starts from its beginning on the next call.
+ *
+ * @param pt pointer to state
+ */
+#define PT_EXIT(pt)                             \
+  do {                                          \
+    PT_INIT(pt);                                \
+    return PT_EXITED;                           \
+  } while (0)
+
+/**
+ * Check if coroutine is still running.
+ *
+ * @param rc value returned by coroutine
+ */
+#define PT_ALIVE(rc) ((rc) < PT_EXITED)
+
+#endif
@@ -0,0 +1,99 @@
+/**
+ * @file pub.h
+ * @author Ilia Proniashin, msg@proglyk.ru
+ * @date 18-October-2026
+ *
+ * Asynchronous publisher interface.
+ * Decouples serial thread from IED server: decoded frames are pushed into
+ * lock-free single-producer/single-consumer rings and applied to the model
+ * by separate publisher thread. Subscription frames are drained before
+ * page frames.
+ */
+
+#ifndef SER2MMS_PUB_H
+#define SER2MMS_PUB_H
+
+#include "ser2mms_conf.h"
+#include "ser.h"
+#include "port_types.h"
+
+/** Use static allocation. */
+#define PUB_USE_STATIC (0)
+
+/** Queue depth, frames (power of 2). */
+#define PUB_DEPTH S2M_PUB_DEPTH
+
+#if (PUB_DEPTH & (PUB_DEPTH - 1))
+#error "Macro 'S2M_PUB_DEPTH' must be a power of 2"
+#endif
+
+#if (S2M_PUB_DROP_OLDEST) && (S2M_PUB_COALESCE)
+#error "Select only one of 'S2M_PUB_DROP_OLDEST' and 'S2M_PUB_COALESCE'"
+#endif
+
+/** Pointer type to publisher object. */
+typedef struct pub_s *pub_t;
+
+/** Publisher statistics. */
+typedef struct {
+  u32_t pushed;     // Frames pushed by serial thread
+  u32_t dropped;    // Frames dropped (drop-oldest policy)
+  u32_t coalesced;  // Frames replaced by newer one of same page
+} pub_stats_t;
+
+// Public interface function declarations
+
+// Basic functions
+
+/**
+ * Publisher object constructor.
+ * Starts publisher thread which applies queued frames by
+ * ser_apply_page/ser_apply_subs of protocol handler.
+ *
+ * @param ser protocol handler
+ * @return pointer to created instance or NULL on error
+ */
+pub_t pub_new(ser_t ser);
+
+/**
+ * Publisher object destructor.
+ * Stops publisher thread; frames left in queues are discarded.
+ *
+ * @param self pointer to instance
+ */
+void pub_destroy(pub_t self);
+
+// Producer side (serial thread)
+
+/**
+ * Queue page values.
+ * Frame timestamp is taken from mms_if_get_stamp of calling thread.
+ *
+ * @param self pointer to instance
+ * @param buf buffer with page data (SER_PAGE_SIZE values)
+ * @param ds dataset index
+ * @param page data page number
+ */
+void pub_push_page(pub_t self, const page_prm_t *buf, u8_t ds, u8_t page);
+
+#if (!S2M_REDUCED)
+/**
+ * Queue subscription values.
+ *
+ * @param self pointer to instance
+ * @param buf buffer with subscription data (SER_NUM_SUBS values)
+ */
+void pub_push_subs(pub_t self, const sub_prm_t *buf);
+#endif
+
+// Helper functions
+
+/**
+ * Get publisher statistics.
+ *
+ * @param self pointer to instance
+ * @param stats pointer to place statistics
+ */
+void pub_get_stats(pub_t self, pub_stats_t *stats);
+
+#endif
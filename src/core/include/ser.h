@@ -13,6 +13,7 @@
 
 #include "ser2mms_conf.h"
 #include "ser_types.h"
+#include "byteops.h"
 #include "port_types.h"
 
 /** Use static allocation. */
@@ -41,12 +42,29 @@
 #define IN_MSG_SIZE_POLL (11)
 #define SER_ANSW_SIZE (3)
 
+/** Size of encoded page value, bytes. */
+#define SER_PAGE_PRM_SIZE (2)
+
+/** Size of encoded subscription value (magnitude, seconds, ms), bytes. */
+#define SER_SUB_PRM_SIZE (8)
+
+/** Size of SLAVE frame payload, bytes. */
+#if (S2M_REDUCED)
+#define SER_FRAME_PLD_SIZE (SER_PAGE_SIZE*SER_PAGE_PRM_SIZE)
+#else
+#define SER_FRAME_PLD_SIZE (SER_PAGE_SIZE*SER_PAGE_PRM_SIZE + \
+                            SER_NUM_SUBS*SER_SUB_PRM_SIZE)
+#endif
+
 /** Shorthand for calling getter for receive buffer pointer. */
 #define GET_RCVD(S) ser_get_buf_rcvd(S)
 
 /** Shorthand for calling getter for transmit buffer pointer. */
 #define GET_XMIT(S) ser_get_buf_xmit(S)
 
+/** Shorthand for calling getter for buffer of next message. */
+#define GET_NEXT(S) ser_get_buf_next(S)
+
 /**
  * Serial protocol buffer structure.
  */
@@ -63,6 +81,7 @@ struct buf_rcvd_s {
   u8_t buf[BUFSIZE];  // Data buffer
   u32_t pos;          // Current position
   u32_t size;         // Data size
+  u64_t ts;           // Time of last received bytes (tmr_now_us), us
 };
 
 /**
@@ -83,9 +102,99 @@ typedef struct buf_xmit_s *buf_xmit_t;
 /** Pointer type to serial protocol buffer. */
 typedef struct ser_buf_s *ser_buf_t;
 
+/**
+ * Read-only view over payload of validated SLAVE frame.
+ * Points into receive buffer, so it is valid only until callback returns.
+ * Values are decoded by accessors below when they are read.
+ */
+typedef struct {
+  const u8_t *pld;  // Page values followed by subscriptions (big-endian)
+  u8_t ds;          // Dataset index
+  u8_t page;        // Data page number
+} frame_view_t;
+
+/**
+ * Get page value.
+ *
+ * @param frm pointer to view
+ * @param i value index (less than SER_PAGE_SIZE)
+ * @return magnitude
+ */
+static inline s16_t frame_page(const frame_view_t *frm, u32_t i)
+{
+  const u8_t *p = frm->pld + i*SER_PAGE_PRM_SIZE;
+  return (s16_t)B_TO_S(p[0], p[1]);
+}
+
+#if (!S2M_REDUCED)
+/**
+ * Get subscription magnitude.
+ *
+ * @param frm pointer to view
+ * @param i subscription index (less than SER_NUM_SUBS)
+ * @return magnitude
+ */
+static inline s16_t frame_mag(const frame_view_t *frm, u32_t i)
+{
+  const u8_t *p = frm->pld + SER_PAGE_SIZE*SER_PAGE_PRM_SIZE +
+                  i*SER_SUB_PRM_SIZE;
+  return (s16_t)B_TO_S(p[0], p[1]);
+}
+
+/**
+ * Get subscription timestamp.
+ *
+ * @param frm pointer to view
+ * @param i subscription index (less than SER_NUM_SUBS)
+ * @param t place for timestamp: seconds and microseconds (as in sub_prm_t)
+ */
+static inline void frame_ts(const frame_view_t *frm, u32_t i, u32_t t[2])
+{
+  const u8_t *p = frm->pld + SER_PAGE_SIZE*SER_PAGE_PRM_SIZE +
+                  i*SER_SUB_PRM_SIZE + 2;
+  t[0] = B_TO_L(p[0], p[1], p[2], p[3]);
+  t[1] = (s16_t)B_TO_S(p[4], p[5]) * 1000U;
+}
+#endif
+
+/**
+ * User callbacks of one instance.
+ * Each is called with context given to ser_set_ops. NULL member means
+ * default implementation (global ser2mms_* function).
+ */
+typedef struct {
+  // SLAVE mode
+  void (*read_page)(const page_prm_t *buf, u8_t ds, u8_t page, void *ctx);
+  void (*read_subs)(const sub_prm_t *buf, void *ctx);
+#if (S2M_USE_FRAME_VIEW)
+  void (*read_frame)(const frame_view_t *frm, void *ctx);
+#endif
+  void (*write_answer)(answ_prm_t *buf, u32_t *buf_len, void *ctx);
+  void (*set_time)(u32_t *epoch, u32_t *usec, void *ctx);
+  // POLL mode
+  void (*write_page)(page_prm_t *buf, u32_t *buf_len, u8_t ds, u8_t page,
+                     void *ctx);
+  void (*write_subs)(sub_prm_t *buf, u32_t *buf_len, void *ctx);
+} ser_ops_t;
+
 /** Pointer type to 'ser' object. */
 typedef struct ser_s *ser_t;
 
+/** Pointer type to mapping object (see map.h). */
+typedef struct map_s *ser_map_t;
+
+/** Pointer type to publisher object (see pub.h). */
+typedef struct pub_s *ser_pub_t;
+
+/** Pointer type to latest-value store object (see store.h). */
+typedef struct store_s *ser_store_t;
+
+/** Pointer type to GOOSE publisher object (see goose.h). */
+typedef struct goose_s *ser_goose_t;
+
+/** Pointer type to precomputed answer object (see answ.h). */
+typedef struct answ_s *ser_answ_t;
+
 // Public interface function declarations
 
 // Basic functions
@@ -120,13 +229,51 @@ void ser_destroy(ser_t self);
 s32_t ser_in_parse(ser_t self);
 
 /**
- * Build outgoing message.
+ * Build outgoing message into buffer of next message.
  * Assembles outgoing message with header and payload for transmission.
  * 
  * @param self pointer to instance
  */
 void ser_out_build(ser_t self);
 
+/**
+ * Drop message built into buffer of next message.
+ * In POLL mode returns dataset and page to values before the last
+ * 'ser_out_build', so rebuilt request asks for the same page.
+ *
+ * @param self pointer to instance
+ */
+void ser_out_drop(ser_t self);
+
+/**
+ * Build speculative reply into buffer of next message.
+ * Only SLAVE mode with precomputed answer: reply to CMD_PARAMETERS doesn't
+ * depend on request, so it can be ready before request arrives.
+ * 
+ * @param self pointer to instance
+ * @param ver pointer to store answer version the reply was built from
+ * @return true if reply was built
+ */
+bool ser_out_spec(ser_t self, u32_t *ver);
+
+/**
+ * Check if speculative reply is still valid.
+ * 
+ * @param self pointer to instance
+ * @param ver answer version the reply was built from
+ * @return true if answer wasn't changed since
+ */
+bool ser_spec_valid(ser_t self, u32_t ver);
+
+/**
+ * Check if speculative reply answers the last received request.
+ * 
+ * @param self pointer to instance
+ * @param ver answer version the reply was built from
+ * @return true if reply can be sent as is
+ */
+bool ser_spec_hit(ser_t self, u32_t ver);
+
 // Helper functions
 
 /**
@@ -138,6 +285,95 @@ void ser_out_build(ser_t self);
  */
 void ser_set_cmd(ser_t self, u32_t value);
 
+/**
+ * Set attribute mapping table.
+ * When table is set, received values are applied by it instead of
+ * calling ser2mms_read_page/ser2mms_read_subs (or ser2mms_read_frame).
+ *
+ * @param self pointer to instance
+ * @param map pointer to mapping object or NULL to use user functions
+ */
+void ser_set_map(ser_t self, ser_map_t map);
+
+#if (S2M_USE_PUB)
+/**
+ * Set publisher.
+ * When publisher is set, received values are queued to it and applied
+ * from publisher thread instead of serial one.
+ *
+ * @param self pointer to instance
+ * @param pub pointer to publisher object or NULL to apply values in place
+ */
+void ser_set_pub(ser_t self, ser_pub_t pub);
+#endif
+
+#if (S2M_USE_STORE)
+/**
+ * Set latest-value store.
+ * When store is set, received values are written to it and committed
+ * by its flusher thread instead of being applied in place.
+ *
+ * @param self pointer to instance
+ * @param store pointer to store object or NULL to apply values in place
+ */
+void ser_set_store(ser_t self, ser_store_t store);
+#endif
+
+#if (S2M_USE_GOOSE)
+/**
+ * Set GOOSE publisher.
+ * Subscription values are published by it as soon as frame is decoded.
+ *
+ * @param self pointer to instance
+ * @param goose pointer to GOOSE publisher object or NULL to disable
+ */
+void ser_set_goose(ser_t self, ser_goose_t goose);
+#endif
+
+/**
+ * Set user callbacks.
+ * Table is copied, so it may be temporary.
+ *
+ * @param self pointer to instance
+ * @param ops callbacks or NULL to use default ones
+ * @param ctx context passed to callbacks or NULL to keep payload API context
+ */
+void ser_set_ops(ser_t self, const ser_ops_t *ops, void *ctx);
+
+/**
+ * Set precomputed answer.
+ * When answer is set, SLAVE reply copies its encoded block instead of
+ * calling ser2mms_write_answer.
+ *
+ * @param self pointer to instance
+ * @param answ pointer to answer object or NULL to use user function
+ */
+void ser_set_answ(ser_t self, ser_answ_t answ);
+
+// Applying received values
+
+/**
+ * Apply page values.
+ * Updates dataset fields by mapping table or ser2mms_read_page.
+ *
+ * @param self pointer to instance
+ * @param buf buffer with page data (SER_PAGE_SIZE values)
+ * @param ds dataset index
+ * @param page data page number
+ */
+void ser_apply_page(ser_t self, const page_prm_t *buf, u8_t ds, u8_t page);
+
+#if (!S2M_REDUCED)
+/**
+ * Apply subscription values.
+ * Updates subscription fields by mapping table or ser2mms_read_subs.
+ *
+ * @param self pointer to instance
+ * @param buf buffer with subscription data (SER_NUM_SUBS values)
+ */
+void ser_apply_subs(ser_t self, const sub_prm_t *buf);
+#endif
+
 /**
  * Get pointer to receive buffer structure.
  * Returns pointer to buffer for placing received data.
@@ -156,4 +392,21 @@ buf_rcvd_t ser_get_buf_rcvd(ser_t self);
  */
 buf_xmit_t ser_get_buf_xmit(ser_t self);
 
+/**
+ * Get pointer to buffer of next message.
+ * Transmit buffer is doubled: 'ser_out_build' fills this one while
+ * the other is sent, 'ser_flip_xmit' swaps them.
+ * 
+ * @param self pointer to instance
+ * @return pointer to buffer being built
+ */
+buf_xmit_t ser_get_buf_next(ser_t self);
+
+/**
+ * Make built message the one to transmit.
+ * 
+ * @param self pointer to instance
+ */
+void ser_flip_xmit(ser_t self);
+
 #endif
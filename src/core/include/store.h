@@ -0,0 +1,83 @@
+/**
+ * @file store.h
+ * @author Ilia Proniashin, msg@proglyk.ru
+ * @date 18-October-2026
+ *
+ * Latest-value store interface.
+ * Received values are written into flat last-value array indexed by point
+ * (flat mapping index, see map.h) and marked in dirty bitmap. Flusher
+ * thread periodically commits only dirty points by mapping table, so work
+ * of IED server is bounded by flush rate regardless of serial rate, and
+ * the latest value of every point is always committed.
+ */
+
+#ifndef SER2MMS_STORE_H
+#define SER2MMS_STORE_H
+
+#include "ser2mms_conf.h"
+#include "map.h"
+#include "port_types.h"
+
+/** Use static allocation. */
+#define STORE_USE_STATIC (0)
+
+/** Flush period, ms. */
+#define STORE_FLUSH_MS S2M_STORE_FLUSH_MS
+
+/** Pointer type to store object. */
+typedef struct store_s *store_t;
+
+// Public interface function declarations
+
+// Basic functions
+
+/**
+ * Store object constructor.
+ * Starts flusher thread.
+ *
+ * @param map mapping table used to commit values
+ * @return pointer to created instance or NULL on error
+ */
+store_t store_new(map_t map);
+
+/**
+ * Store object destructor.
+ * Stops flusher thread and commits values left dirty.
+ *
+ * @param self pointer to instance
+ */
+void store_destroy(store_t self);
+
+// Writer side (serial thread)
+
+/**
+ * Store page values.
+ * Frame timestamp is taken from mms_if_get_stamp of calling thread.
+ *
+ * @param self pointer to instance
+ * @param buf buffer with page data (SER_PAGE_SIZE values)
+ * @param ds dataset index
+ * @param page data page number
+ */
+void store_put_page(store_t self, const page_prm_t *buf, u8_t ds, u8_t page);
+
+/**
+ * Store subscription values.
+ *
+ * @param self pointer to instance
+ * @param buf buffer with subscription data (MAP_NUM_SUBS values)
+ */
+void store_put_subs(store_t self, const sub_prm_t *buf);
+
+// Committing values
+
+/**
+ * Commit dirty points.
+ * Called by flusher thread every STORE_FLUSH_MS.
+ *
+ * @param self pointer to instance
+ * @return number of committed points
+ */
+u32_t store_flush(store_t self);
+
+#endif
@@ -14,6 +14,8 @@
 #include "ser2mms_conf.h"
 // #include "types.h"
 #include "port_types.h"
+#include "port_rs485.h"
+#include <stdbool.h>
 
 /** Use static allocation. */
 #define TRANSP_USE_STATIC (0)
@@ -70,6 +72,63 @@ void transp_run(transp_t *self);
  */
 int transp_poll(transp_t *self);
 
+/**
+ * Poll receive part of transport layer.
+ * Entry of receive thread in split mode (S2M_USE_SPLIT_RXTX).
+ * 
+ * @param self pointer to object
+ * @return 0 on success
+ */
+int transp_poll_rx(transp_t *self);
+
+/**
+ * Poll transmit part of transport layer.
+ * Entry of transmit thread in split mode: handles timer, user and control
+ * events, builds and sends requests.
+ * 
+ * @param self pointer to object
+ * @return 0 on success
+ */
+int transp_poll_tx(transp_t *self);
+
+/**
+ * Check if receive and transmit parts run in separate threads.
+ * 
+ * @param self pointer to object
+ * @return true in POLL mode with S2M_USE_SPLIT_RXTX
+ */
+bool transp_is_split(transp_t *self);
+
+/**
+ * Process transport layer without blocking.
+ * For external event loop: called when descriptors returned by
+ * transp_get_fds() are ready or timeout of transp_get_timeout() expired.
+ * 
+ * @param self pointer to object
+ * @param rx_ready serial port descriptor is readable
+ * @return 0 on success
+ */
+int transp_process(transp_t *self, bool rx_ready);
+
+/**
+ * Get descriptors to wait for.
+ * First one is serial port, then (if supported) event queues.
+ * 
+ * @param self pointer to object
+ * @param fds array to place descriptors
+ * @param max array size
+ * @return number of descriptors placed
+ */
+u32_t transp_get_fds(transp_t *self, fd_t *fds, u32_t max);
+
+/**
+ * Get time to next deadline (frame gap of receiver).
+ * 
+ * @param self pointer to object
+ * @return time, ms (0 - expired, -1 - no deadline)
+ */
+s32_t transp_get_timeout(transp_t *self);
+
 // Helper functions
 
 /**
@@ -80,6 +139,25 @@ int transp_poll(transp_t *self);
  */
 void transp_tick(transp_t *self);
 
+/**
+ * Interrupt waiting in transp_poll().
+ * May be called from any thread, e.g. to make polling thread notice
+ * stop request at once.
+ * 
+ * @param self pointer to object
+ */
+void transp_wake(transp_t *self);
+
+/**
+ * Request command change.
+ * Command is queued and applied by transport thread between frames,
+ * so it may be called from any thread.
+ * 
+ * @param self pointer to object
+ * @param cmd new command
+ */
+void transp_exec(transp_t *self, u32_t cmd);
+
 /**
  * UART receive interrupt entry point.
  * Interrupt handler for receiving data via serial interface.
@@ -106,10 +184,46 @@ void *transp_get_top(transp_t *self);
 
 /**
  * Device ID setter.
+ * Change is posted to event queue and applied between frames, prebuilt
+ * message with previous address is dropped.
  * 
  * @param self pointer to object
  * @param id new device address identifier
  */
 void transp_set_id(transp_t *self, u32_t id);
 
+/**
+ * Getter for number of events lost because event queue was full.
+ * 
+ * @param self pointer to object
+ * @return number of lost events
+ */
+u32_t transp_get_ev_lost(transp_t *self);
+
+/**
+ * Getter for number of requests left without reply after all repeats
+ * (POLL mode).
+ * 
+ * @param self pointer to object
+ * @return number of requests
+ */
+u32_t transp_get_rsp_lost(transp_t *self);
+
+/**
+ * Getter for number of master retries answered from cache (SLAVE mode,
+ * S2M_DUP_WINDOW_MS).
+ * 
+ * @param self pointer to object
+ * @return number of retries
+ */
+u32_t transp_get_dup_hits(transp_t *self);
+
+/**
+ * Getter for receive statistics of serial port.
+ * 
+ * @param self pointer to object
+ * @param stats pointer to place statistics
+ */
+void transp_get_rx_stats(transp_t *self, rs485_stats_t *stats);
+
 #endif
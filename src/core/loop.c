@@ -0,0 +1,166 @@
+/**
+ * @file loop.c
+ * @author Ilia Proniashin, msg@proglyk.ru
+ * @date 18-October-2026
+ *
+ * Session scheduler implementation.
+ *
+ * Every descriptor of session is added to poller with the session index as
+ * key. Session without descriptors (interrupt driven port) is processed on
+ * every pass. Slot of removed session is left empty and taken by the next
+ * added one, so keys of other sessions never change.
+ */
+
+#include "loop.h"
+#include "alloc.h"
+#include "port_poller.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+/** Maximum descriptors of one session. */
+#define LOOP_SESSION_FDS (3)
+
+/** Maximum ready keys taken per pass. */
+#define LOOP_BATCH (64)
+
+/**
+ * Session.
+ */
+typedef struct {
+  transp_t *tp;  // Transport layer
+  bool polled;   // Session has descriptors
+  bool ready;    // Some descriptor is ready
+} sess_t;
+
+/**
+ * Internal scheduler structure.
+ */
+struct loop_s {
+  poller_t poller;                     // Descriptor waiting
+  sess_t sess[LOOP_MAX_SESSIONS];     // Sessions
+  u32_t num;                           // Number of sessions
+  u32_t keys[LOOP_BATCH];             // Ready keys of pass
+};
+
+STATIC_DECLARE(LOOP, struct loop_s);
+
+// Public interface function definitions
+
+// Basic functions
+
+/**
+ * 'loop' object constructor.
+ */
+loop_t loop_new(void)
+{
+  ALLOC(LOOP, struct loop_s, self, return NULL);
+
+  self->poller = poller_new();
+  if (!self->poller) {
+    printf("[loop_new] poller_new() returned FAIL\n");
+    FREE(LOOP, self);
+    return NULL;
+  }
+  return self;
+}
+
+/**
+ * 'loop' object destructor.
+ */
+void loop_destroy(loop_t self)
+{
+  assert(self);
+  poller_del(self->poller);
+  FREE(LOOP, self);
+}
+
+/**
+ * Add session.
+ */
+s32_t loop_add(loop_t self, transp_t *tp)
+{
+  fd_t fds[LOOP_SESSION_FDS];
+  assert(self && tp);
+
+  // First empty slot, or a new one past the used ones
+  u32_t idx = 0;
+  while ((idx < self->num) && self->sess[idx].tp) idx++;
+  if (idx >= LOOP_MAX_SESSIONS) return -1;
+
+  sess_t *sess = &self->sess[idx];
+  u32_t num = transp_get_fds(tp, fds, LOOP_SESSION_FDS);
+  for (u32_t i=0; i<num; i++) {
+    if (!poller_add(self->poller, fds[i], idx)) {
+      printf("[loop_add] Can't wait for descriptor %d\n", (int)fds[i]);
+      // Session is added entirely or not at all
+      while (i--) poller_rem(self->poller, fds[i]);
+      return -1;
+    }
+  }
+  sess->tp = tp;
+  sess->polled = (num > 0);
+  sess->ready = false;
+  if (idx == self->num) self->num++;
+  return 0;
+}
+
+/**
+ * Remove session.
+ */
+s32_t loop_remove(loop_t self, transp_t *tp)
+{
+  fd_t fds[LOOP_SESSION_FDS];
+  assert(self && tp);
+
+  u32_t idx = 0;
+  while ((idx < self->num) && (self->sess[idx].tp != tp)) idx++;
+  if (idx == self->num) return -1;
+
+  if (self->sess[idx].polled) {
+    u32_t num = transp_get_fds(tp, fds, LOOP_SESSION_FDS);
+    for (u32_t i=0; i<num; i++) poller_rem(self->poller, fds[i]);
+  }
+  self->sess[idx].tp = NULL;
+  self->sess[idx].ready = false;
+  // Trailing empty slots aren't scanned
+  while (self->num && !self->sess[self->num - 1].tp) self->num--;
+  return 0;
+}
+
+/**
+ * Run one pass.
+ */
+s32_t loop_run(loop_t self, s32_t wait_ms)
+{
+  s32_t cnt = 0;
+  assert(self);
+
+  // Sleep until the nearest deadline of sessions
+  s32_t tmo = wait_ms;
+  for (u32_t i=0; i<self->num; i++) {
+    if (!self->sess[i].tp) continue;
+    s32_t t = transp_get_timeout(self->sess[i].tp);
+    if ((t >= 0) && ((tmo < 0) || (t < tmo))) tmo = t;
+  }
+
+  s32_t n = poller_wait(self->poller, self->keys, LOOP_BATCH, tmo);
+  if (n < 0) return -1;
+  for (s32_t i=0; i<n; i++) {
+    if (self->keys[i] < self->num) self->sess[self->keys[i]].ready = true;
+  }
+
+  for (u32_t i=0; i<self->num; i++) {
+    sess_t *sess = &self->sess[i];
+    if (!sess->tp) continue;
+    if (sess->ready || !sess->polled ||
+        (transp_get_timeout(sess->tp) == 0)) {
+      // Readiness of serial port isn't told apart from events: reading
+      // idle port costs one call returning nothing
+      transp_process(sess->tp, true);
+      sess->ready = false;
+      cnt++;
+    }
+  }
+  return cnt;
+}
@@ -0,0 +1,360 @@
+/**
+ * @file map.c
+ * @author Ilia Proniashin, msg@proglyk.ru
+ * @date 18-October-2026
+ *
+ * Attribute mapping table implementation.
+ */
+
+#include "map.h"
+#include "alloc.h"
+#include "port_tmr.h"
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+
+/** Maximum length of mapping file line and attribute reference. */
+#define MAP_LINE_LEN (256)
+
+/**
+ * Filter state of one entry.
+ */
+typedef struct {
+  f32_t val;    // Last written value
+  u32_t t[2];   // Last written external timestamp
+  u64_t upd_us; // Time of last update, us
+  bool valid;   // Value was written at least once
+} flt_t;
+
+/**
+ * Entries loaded from file, static table is used in place.
+ */
+typedef struct {
+  map_ent_t ent[MAP_NUM_ENTS];
+} map_tbl_t;
+
+/**
+ * Internal mapping object structure.
+ */
+struct map_s {
+  void *ied;                    // Pointer to IED server
+  const map_ent_t *ents;        // Entries in use (flat array)
+  flt_t flt[MAP_NUM_ENTS];      // Filter state (same indexing as entries)
+  map_ent_t *tbl;               // Entries loaded from file, NULL if static
+};
+
+#define MAP_TBL_USE_STATIC MAP_USE_STATIC
+
+STATIC_DECLARE(MAP, struct map_s);
+STATIC_DECLARE(MAP_TBL, map_tbl_t);
+
+// Private function declarations
+
+static s32_t parse_line(map_t, char *, u32_t);
+static s32_t resolve(map_t, map_ent_t *, const char *, const char *);
+static s32_t parse_filter(map_ent_t *, char *);
+static bool filter(map_t, u32_t, s16_t, const u32_t *);
+static f32_t convert(const map_ent_t *, s16_t);
+
+// Public interface function definitions
+
+// Basic functions
+
+/**
+ * Constructor.
+ */
+map_t map_new(void *ied, const char *path)
+{
+  char line[MAP_LINE_LEN];
+  u32_t lnum = 0;
+  assert(ied && path);
+
+  FILE *f = fopen(path, "r");
+  if (!f) {
+    printf("[map_new] Can't open file '%s'\n", path);
+    return NULL;
+  }
+
+  ALLOC(MAP, struct map_s, self, goto error_0);
+  self->ied = ied;
+  ALLOC(MAP_TBL, map_tbl_t, tbl, goto error_1);
+  self->tbl = tbl->ent;
+  self->ents = self->tbl;
+
+  while (fgets(line, sizeof(line), f)) {
+    lnum++;
+    if (parse_line(self, line, lnum) < 0) goto error_1;
+  }
+  fclose(f);
+  return self;
+
+error_1:
+  map_destroy(self);
+error_0:
+  fclose(f);
+  return NULL;
+}
+
+/**
+ * Constructor for static table.
+ */
+map_t map_new_static(void *ied, const map_ent_t *tbl)
+{
+  assert(ied && tbl);
+  ALLOC(MAP, struct map_s, self, return NULL);
+  self->ied = ied;
+  self->ents = tbl;
+  return self;
+}
+
+/**
+ * Destructor.
+ */
+void map_destroy(map_t self)
+{
+  assert(self);
+  if (self->tbl) FREE(MAP_TBL, self->tbl);
+  FREE(MAP, self);
+}
+
+// Applying values
+
+/**
+ * Apply page values.
+ */
+void map_apply_page(map_t self, const page_prm_t *buf, u8_t ds, u8_t page)
+{
+  assert(self && buf);
+  u32_t idx = MAP_PAGE_IDX(ds, page, 0);
+  const map_ent_t *ent = &self->ents[idx];
+
+  for (u32_t i=0; i<SER_PAGE_SIZE; i++, idx++, ent++) {
+    if (ent->set && filter(self, idx, buf[i].mag, NULL)) {
+      ent->set(self->ied, ent, buf[i].mag, NULL);
+    }
+  }
+}
+
+/**
+ * Apply subscription values.
+ */
+void map_apply_subs(map_t self, const sub_prm_t *buf)
+{
+  assert(self && buf);
+  u32_t idx = MAP_SUB_IDX(0);
+  const map_ent_t *ent = &self->ents[idx];
+
+  for (u32_t i=0; i<MAP_NUM_SUBS; i++, idx++, ent++) {
+    if (ent->set && filter(self, idx, buf[i].mag, buf[i].t)) {
+      ent->set(self->ied, ent, buf[i].mag, buf[i].t);
+    }
+  }
+}
+
+/**
+ * Apply single value.
+ */
+void map_apply_point(map_t self, u32_t idx, s16_t raw, const u32_t *ts)
+{
+  assert(self && (idx < MAP_NUM_ENTS));
+  const map_ent_t *ent = &self->ents[idx];
+  if (ent->set && filter(self, idx, raw, ts)) {
+    ent->set(self->ied, ent, raw, ts);
+  }
+}
+
+// Typed setters
+
+/**
+ * Setter for attributes with int32 type in mag.
+ */
+bool map_set_s32(void *ied, const map_ent_t *ent, s16_t raw, const u32_t *ts)
+{
+  f32_t val = convert(ent, raw);
+  bool rc = mms_if_set_attr_s32(ied, ent->mag, MAP_TO_S32(val));
+  if (ent->t) rc &= mms_if_set_attr_t(ied, ent->t, ts);
+  if (ent->q) rc &= mms_if_set_attr_q(ied, ent->q, true);
+  return rc;
+}
+
+/**
+ * Setter for attributes with float32 type in mag.
+ */
+bool map_set_f32(void *ied, const map_ent_t *ent, s16_t raw, const u32_t *ts)
+{
+  bool rc = mms_if_set_attr_f32(ied, ent->mag, convert(ent, raw));
+  if (ent->t) rc &= mms_if_set_attr_t(ied, ent->t, ts);
+  if (ent->q) rc &= mms_if_set_attr_q(ied, ent->q, true);
+  return rc;
+}
+
+// Private function definitions
+
+/**
+ * Parse one line of mapping file.
+ *
+ * @param self pointer to instance
+ * @param line line text
+ * @param lnum line number (for diagnostics)
+ * @return 0 on success or empty line, -1 on error
+ */
+static s32_t parse_line(map_t self, char *line, u32_t lnum)
+{
+  char kind;
+  char type[4];
+  char ref[MAP_LINE_LEN];
+  u32_t ds, page, i;
+  f32_t scale, offset;
+  u32_t idx;
+  int len = 0;
+
+  // Skip leading spaces, empty lines and comments
+  while ((*line == ' ') || (*line == '\t')) line++;
+  if ((*line == '#') || (*line == '\n') || (*line == '\r') || !*line) {
+    return 0;
+  }
+  kind = *line++;
+
+  if (kind == 'P') {
+    if ((sscanf(line, "%u %u %u %3s %f %f %255s%n", &ds, &page, &i, type,
+                &scale, &offset, ref, &len) != 7) ||
+        (ds < SER_MIN_DS_IDX) || (ds > SER_MAX_DS_IDX) ||
+        (page > SER_MAX_PAGE_IDX) || (i >= SER_PAGE_SIZE)) {
+      goto error;
+    }
+    idx = MAP_PAGE_IDX(ds, page, i);
+  } else if (kind == 'S') {
+    if ((sscanf(line, "%u %3s %f %f %255s%n", &i, type, &scale, &offset,
+                ref, &len) != 5) || (i >= MAP_NUM_SUBS)) {
+      goto error;
+    }
+    idx = MAP_SUB_IDX(i);
+  } else {
+    goto error;
+  }
+
+  self->tbl[idx].scale = scale;
+  self->tbl[idx].offset = offset;
+  if (parse_filter(&self->tbl[idx], line + len) < 0) goto error;
+  if (resolve(self, &self->tbl[idx], type, ref) < 0) goto error;
+  return 0;
+
+error:
+  printf("[map_new] Invalid entry at line %u\n", lnum);
+  return -1;
+}
+
+/**
+ * Parse optional filter settings of entry.
+ *
+ * @param ent entry to fill
+ * @param opts rest of line after reference
+ * @return 0 on success, -1 on error
+ */
+static s32_t parse_filter(map_ent_t *ent, char *opts)
+{
+  char *save;
+  for (char *tok = strtok_r(opts, " \t\r\n", &save); tok;
+       tok = strtok_r(NULL, " \t\r\n", &save)) {
+    if (sscanf(tok, "db=%f", &ent->db_abs) == 1) continue;
+    if (sscanf(tok, "dbp=%f", &ent->db_pct) == 1) continue;
+    if (sscanf(tok, "min=%u", &ent->min_ms) == 1) continue;
+    return -1;
+  }
+  return 0;
+}
+
+/**
+ * Deadband and rate-limit filter.
+ * Decides whether value of entry must be written and updates filter state.
+ *
+ * @param self pointer to instance
+ * @param idx flat index of entry
+ * @param raw raw value from frame
+ * @param ts external timestamp or NULL
+ * @return true if value must be written, false if it is suppressed
+ */
+static bool filter(map_t self, u32_t idx, s16_t raw, const u32_t *ts)
+{
+  const map_ent_t *ent = &self->ents[idx];
+  flt_t *flt = &self->flt[idx];
+
+  // Entry without filter
+  if (!ent->min_ms && (ent->db_abs <= 0) && (ent->db_pct <= 0)) return true;
+
+  f32_t val = convert(ent, raw);
+  u64_t now = tmr_now_us();
+
+  // First value and change of external timestamp always pass
+  if (flt->valid && !(ts && ((ts[0] != flt->t[0]) || (ts[1] != flt->t[1])))) {
+    // Minimum interval
+    if (ent->min_ms && ((now - flt->upd_us) < (u64_t)ent->min_ms * 1000U)) {
+      return false;
+    }
+    // Deadbands
+    f32_t diff = val - flt->val;
+    f32_t last = flt->val;
+    if (diff < 0) diff = -diff;
+    if (last < 0) last = -last;
+    if ((ent->db_abs > 0) && (diff <= ent->db_abs)) return false;
+    if ((ent->db_pct > 0) && (diff <= last * ent->db_pct / 100.0f)) {
+      return false;
+    }
+  }
+
+  flt->val = val;
+  if (ts) {
+    flt->t[0] = ts[0];
+    flt->t[1] = ts[1];
+  }
+  flt->upd_us = now;
+  flt->valid = true;
+  return true;
+}
+
+/**
+ * Resolve entry attributes and setter.
+ *
+ * @param self pointer to instance
+ * @param ent entry to fill
+ * @param type value type ("s32" or "f32")
+ * @param ref data object reference
+ * @return 0 on success, -1 on error
+ */
+static s32_t resolve(map_t self, map_ent_t *ent, const char *type,
+                     const char *ref)
+{
+  char name[MAP_LINE_LEN + 8];
+  const char *mag_suf;
+
+  if (!strcmp(type, "s32")) {
+    ent->set = map_set_s32;
+    mag_suf = "mag.i";
+  } else if (!strcmp(type, "f32")) {
+    ent->set = map_set_f32;
+    mag_suf = "mag.f";
+  } else {
+    return -1;
+  }
+
+  snprintf(name, sizeof(name), "%s.%s", ref, mag_suf);
+  ent->mag = mms_if_find_attr(self->ied, name);
+  if (!ent->mag) {
+    printf("[map_new] Attribute '%s' not found\n", name);
+    ent->set = NULL;
+    return -1;
+  }
+  snprintf(name, sizeof(name), "%s.t", ref);
+  ent->t = mms_if_find_attr(self->ied, name);
+  snprintf(name, sizeof(name), "%s.q", ref);
+  ent->q = mms_if_find_attr(self->ied, name);
+  return 0;
+}
+
+/**
+ * Convert raw value with entry scale and offset.
+ */
+static f32_t convert(const map_ent_t *ent, s16_t raw)
+{
+  return (f32_t)raw * ent->scale + ent->offset;
+}
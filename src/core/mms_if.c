@@ -7,30 +7,98 @@
  */
 
 #include "mms_if.h"
+#include "byteops.h"
+#include "port_thread.h"
 #include <stdio.h>
 #include <assert.h>
+#include <stdatomic.h>
 #include <time.h>
 
+/** UtcTime accuracy (number of significant fraction bits). */
+#define UTC_ACC_MS (10) // Millisecond timestamps
+#define UTC_ACC_US (20) // Microsecond timestamps
+
+// Type declarations
+
+/**
+ * Write handler slot. Registered in IED server once and never freed, since
+ * libiec61850 keeps parameter of the first registration of attribute.
+ */
+typedef struct {
+  void *ied;                            // IED server instance
+  DataAttribute *attr;                  // Attribute
+  _Atomic(mms_if_wr_hnd_t *) hnd;       // Current registration or NULL
+  atomic_uint busy;                     // Handler calls in progress
+} wr_slot_t;
+
+// Variable declarations
+
+// Write handler slots
+static wr_slot_t wr_slot[MMS_IF_WR_SLOTS];
+static u32_t wr_num = 0;
+
+// Timestamp of the frame being processed (epoch seconds, microseconds).
+static __THREAD u32_t stamp[2];
+
+// Cached UtcTime value, the timestamp and accuracy it currently holds.
+static __THREAD MmsValue *utc_val = NULL;
+static __THREAD u32_t utc_ts[2];
+static __THREAD bool utc_us;
+
 // Private function declarations
 
-#if (!S2M_USE_LIBIEC)
-// Private function prototypes for libiec61850 API emulation
-static MmsValue* MmsValue_newIntegerFromInt32(s32_t);
-static MmsValue* MmsValue_newFloat(f32_t);
-static MmsValue* MmsValue_newBitString(u32_t argc);
-static void MmsValue_setBitStringBit(MmsValue *mms, int, bool);
-static void MmsValue_delete(MmsValue* mms);
-#if (S2M_USE_OLD_LIBIEC_API)
-static bool IedServer_updateAttributeValue(void *, DataAttribute *, MmsValue *);
-static MmsValue *MmsValue_newUtcTimeByTimestamp(u32_t *);
-#else
-static void IedServer_updateAttributeValue(void *, DataAttribute *, MmsValue *);
-static MmsValue *MmsValue_newUtcTime(uint32_t timeval);
-#endif
-#endif
+static void get_sys_time(u32_t *);
+static MmsValue *get_utc(const u32_t *, bool);
+static bool to_s32(const MmsValue *, s32_t *);
+static wr_slot_t *find_slot(void *, DataAttribute *);
+static MmsDataAccessError on_write(DataAttribute *, MmsValue *,
+                                   ClientConnection, void *);
 
 // Public interface function definitions
 
+/**
+ * Take frame timestamp.
+ */
+void mms_if_stamp(const u32_t *ts_ext)
+{
+  if (ts_ext) {
+    stamp[0] = ts_ext[0];
+    stamp[1] = ts_ext[1];
+  } else {
+    get_sys_time(stamp);
+  }
+}
+
+/**
+ * End of frame.
+ */
+void mms_if_unstamp(void)
+{
+  stamp[0] = 0;
+  stamp[1] = 0;
+}
+
+/**
+ * Free resources of calling thread.
+ */
+void mms_if_release(void)
+{
+  if (utc_val) {
+    MmsValue_delete(utc_val);
+    utc_val = NULL;
+  }
+}
+
+/**
+ * Get frame timestamp.
+ */
+void mms_if_get_stamp(u32_t *ts)
+{
+  assert(ts);
+  ts[0] = stamp[0];
+  ts[1] = stamp[1];
+}
+
 /**
  * Set INT32 value of target attribute.
  */
@@ -88,39 +156,32 @@ bool mms_if_set_attr_t(void *argv, DataAttribute *attr, const u32_t *ts_ext)
 {
   bool rc = true;
   IedServer ied = (IedServer)argv;
-  uint32_t ts_int[2];
   assert(ied && attr);
 
+  // Without external value use frame time, outside of frame take it now.
+  // Both come from system clock, external ones from the wire in ms
+  u32_t now[2];
+  bool us = !ts_ext;
   if (!ts_ext) {
-#if (PORT_IMPL==PORT_IMPL_LINUX)
-    struct timespec tspec;
-    clock_gettime(CLOCK_REALTIME, &tspec);
-    ts_int[0] = tspec.tv_sec;
-    ts_int[1] = tspec.tv_nsec / 1000;
-#elif (PORT_IMPL==PORT_IMPL_RTOS)
-    #error "Not available"
-    // Get time from RTC
-#elif (PORT_IMPL==PORT_IMPL_BARE)
-    #error "Not available"
-    // Get time from RTC
-#else
-    #error "PORT_IMPL must be defined"
-#endif
+    if (stamp[0]) {
+      ts_ext = stamp;
+    } else {
+      get_sys_time(now);
+      ts_ext = now;
+    }
   }
 
-  // Create timestamp MmsValue
-  MmsValue* pTimeMms = MmsValue_newUtcTime(ts_int[0]);
+  // Get cached timestamp MmsValue
+  MmsValue* pTimeMms = get_utc(ts_ext, us);
   if (!pTimeMms) return false;
 
-  // Update attribute
+  // Update attribute (value is copied, cache stays valid)
 #if (S2M_USE_OLD_LIBIEC_API)
   rc = IedServer_updateAttributeValue(ied, attr, pTimeMms);
 #else
   IedServer_updateAttributeValue(ied, attr, pTimeMms);
 #endif
 
-  // Free resource
-  MmsValue_delete(pTimeMms);
   return rc;
 }
 
@@ -152,69 +213,219 @@ bool mms_if_set_attr_q(void *argv, DataAttribute* attr, const bool quality)
   return rc;
 }
 
-#if (!S2M_USE_LIBIEC)
 /**
- * Stub functions for libiec61850 internal API emulation.
- * Used when library is unavailable.
+ * Find attribute by object reference.
  */
-static MmsValue *MmsValue_newFloat(f32_t value)
+DataAttribute *mms_if_find_attr(void *argv, const char *ref)
 {
-  (void)value;
-  return NULL;
+  IedServer ied = (IedServer)argv;
+  assert(ied && ref);
+
+#if (S2M_USE_LIBIEC)
+  ModelNode *node = IedModel_getModelNodeByObjectReference(
+    IedServer_getDataModel(ied), ref);
+  if (!node || (ModelNode_getType(node) != DataAttributeModelType)) {
+    return NULL;
+  }
+  return (DataAttribute *)node;
+#else
+  return iedsim_find(ied, ref);
+#endif
 }
 
-static MmsValue *MmsValue_newIntegerFromInt32(s32_t value)
+/**
+ * Get value of attribute as int32.
+ */
+bool mms_if_get_attr_s32(DataAttribute *attr, s32_t *value)
 {
-  (void)value;
-  return NULL;
+  assert(attr && value);
+  return attr->mmsValue ? to_s32(attr->mmsValue, value) : false;
 }
 
-static MmsValue *MmsValue_newBitString(u32_t argc)
+/**
+ * Install write handler of attribute.
+ */
+bool mms_if_on_write(void *argv, DataAttribute *attr, mms_if_wr_hnd_t *hnd)
 {
-  (void)argc;
-  return NULL;
+  assert(argv && attr && hnd && hnd->cb);
+  wr_slot_t *slot = find_slot(argv, attr);
+
+  if (!slot) {
+    if (wr_num >= MMS_IF_WR_SLOTS) {
+      printf("[mms_if_on_write] No free handler slots\n");
+      return false;
+    }
+    slot = &wr_slot[wr_num];
+    slot->ied = argv;
+    slot->attr = attr;
+    atomic_init(&slot->hnd, hnd);
+    atomic_init(&slot->busy, 0);
+    wr_num++;
+    IedServer_handleWriteAccess((IedServer)argv, attr, on_write, (void *)slot);
+  } else {
+    atomic_store(&slot->hnd, hnd);
+  }
+  return true;
 }
 
-static void MmsValue_setBitStringBit(MmsValue *mms, int value, bool q)
+/**
+ * Remove write handler of attribute.
+ */
+void mms_if_off_write(void *argv, DataAttribute *attr)
 {
-  (void)mms;
-  (void)value;
-  (void)q;
+  assert(argv && attr);
+  wr_slot_t *slot = find_slot(argv, attr);
+  if (!slot) return;
+
+  // Slot stays installed, only registration is dropped. Wait for handler
+  // calls which may still use it
+  atomic_store(&slot->hnd, NULL);
+  while (atomic_load(&slot->busy)) {
+    thread_sleep(1);
+  }
 }
 
-static void MmsValue_delete(MmsValue *mms)
+/**
+ * Encode timestamp as UtcTime.
+ */
+void mms_if_encode_utc(u8_t *buf, const u32_t *ts, bool us)
 {
-  (void)mms;
+  u32_t usec = (ts[1] < 1000000U) ? ts[1] : 999999U;
+  assert(buf);
+
+  // Seconds, 24-bit fraction of second and time quality
+  u32_t frac = (u32_t)(((u64_t)usec << 24) / 1000000U);
+  I_TO_PB(buf, ts[0]);
+  buf[4] = (u8_t)((frac >> 16) & 0xff);
+  buf[5] = (u8_t)((frac >> 8) & 0xff);
+  buf[6] = (u8_t)(frac & 0xff);
+  buf[7] = us ? UTC_ACC_US : UTC_ACC_MS;
 }
 
-#if (S2M_USE_OLD_LIBIEC_API)
-static MmsValue *MmsValue_newUtcTimeByTimestamp(u32_t *timestamp)
+// Private function definitions
+
+/**
+ * Read system time.
+ *
+ * @param ts pointer to place time (epoch seconds, microseconds)
+ */
+static void get_sys_time(u32_t *ts)
 {
-  (void)timestamp;
-  return NULL;
+#if (PORT_IMPL==PORT_IMPL_LINUX)
+  struct timespec tspec;
+  clock_gettime(CLOCK_REALTIME, &tspec);
+  ts[0] = tspec.tv_sec;
+  ts[1] = tspec.tv_nsec / 1000;
+#elif (PORT_IMPL==PORT_IMPL_RTOS)&&(RTOS_HW_IMPL==RTOS_HW_IMPL_SIM)
+  // POSIX simulator runs on host, take host clock
+  struct timespec tspec;
+  clock_gettime(CLOCK_REALTIME, &tspec);
+  ts[0] = tspec.tv_sec;
+  ts[1] = tspec.tv_nsec / 1000;
+#elif (PORT_IMPL==PORT_IMPL_RTOS)
+  #error "Not available"
+  // Get time from RTC
+#elif (PORT_IMPL==PORT_IMPL_BARE)
+  #error "Not available"
+  // Get time from RTC
+#else
+  #error "PORT_IMPL must be defined"
+#endif
 }
 
-static bool
-IedServer_updateAttributeValue(void *ied, DataAttribute *attr, MmsValue *mms)
+/**
+ * Get UtcTime value for timestamp.
+ * Re-encodes cached value only if timestamp differs from the one it holds.
+ * Fraction of second is encoded with microsecond precision.
+ *
+ * @param ts timestamp (epoch seconds, microseconds)
+ * @param us true for system clock, false for millisecond wire timestamp
+ * @return pointer to cached value, NULL on allocation error
+ */
+static MmsValue *get_utc(const u32_t *ts, bool us)
 {
-  (void)ied;
-  (void)attr;
-  (void)mms;
-  return false;
+  u8_t raw[8];
+  u32_t usec = (ts[1] < 1000000U) ? ts[1] : 999999U;
+
+  if (!utc_val) {
+    utc_val = MmsValue_newUtcTime(0);
+    if (!utc_val) return NULL;
+  } else if ((utc_ts[0] == ts[0]) && (utc_ts[1] == usec) && (utc_us == us)) {
+    return utc_val;
+  }
+
+  mms_if_encode_utc(raw, ts, us);
+  MmsValue_setUtcTimeByBuffer(utc_val, raw);
+
+  utc_ts[0] = ts[0];
+  utc_ts[1] = usec;
+  utc_us = us;
+  return utc_val;
 }
-#else // S2M_USE_OLD_LIBIEC_API
-static MmsValue *MmsValue_newUtcTime(uint32_t timeval)
+
+/**
+ * Convert value to int32.
+ *
+ * @param mms value
+ * @param value pointer to place result
+ * @return true on success, false if type isn't supported
+ */
+static bool to_s32(const MmsValue *mms, s32_t *value)
 {
-  (void)timeval;
-  return NULL;
+  f32_t f;
+  switch (MmsValue_getType(mms)) {
+    case MMS_INTEGER: *value = MmsValue_toInt32(mms); break;
+    case MMS_UNSIGNED: *value = (s32_t)MmsValue_toUint32(mms); break;
+    case MMS_BOOLEAN: *value = MmsValue_getBoolean(mms) ? 1 : 0; break;
+    case MMS_FLOAT:
+      f = MmsValue_toFloat(mms);
+      *value = (s32_t)(f + ((f < 0) ? -0.5f : 0.5f));
+      break;
+    default: return false;
+  }
+  return true;
 }
 
-static void
-IedServer_updateAttributeValue(void *ied, DataAttribute *attr, MmsValue *mms)
+/**
+ * Write access handler of IED server.
+ * Converts written value and passes it to registered handler.
+ */
+static MmsDataAccessError on_write(DataAttribute *attr, MmsValue *mms,
+                                   ClientConnection conn, void *param)
 {
-  (void)ied;
-  (void)attr;
-  (void)mms;
+  wr_slot_t *slot = (wr_slot_t *)param;
+  MmsDataAccessError res = DATA_ACCESS_ERROR_SUCCESS;
+  mms_if_wr_hnd_t *hnd;
+  s32_t value;
+  (void)conn;
+
+  // Mark call before taking registration, so mms_if_off_write waits for it
+  atomic_fetch_add(&slot->busy, 1);
+  hnd = atomic_load(&slot->hnd);
+  if (hnd) {                                    // Else handler removed
+    if (!to_s32(mms, &value)) {
+      res = DATA_ACCESS_ERROR_TYPE_INCONSISTENT;
+    } else if (!hnd->cb(attr, value, hnd->ctx)) {
+      res = DATA_ACCESS_ERROR_OBJECT_VALUE_INVALID;
+    }
+  }
+  atomic_fetch_sub(&slot->busy, 1);
+  return res;
+}
+
+/**
+ * Find write handler slot of attribute.
+ *
+ * @param ied IED server instance
+ * @param attr attribute
+ * @return pointer to slot, NULL if attribute has no slot
+ */
+static wr_slot_t *find_slot(void *ied, DataAttribute *attr)
+{
+  for (u32_t i=0; i<wr_num; i++) {
+    if ((wr_slot[i].ied == ied) && (wr_slot[i].attr == attr)) {
+      return &wr_slot[i];
+    }
+  }
+  return NULL;
 }
-#endif // S2M_USE_OLD_LIBIEC_API
-#endif // S2M_USE_LIBIEC
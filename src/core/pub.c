@@ -0,0 +1,418 @@
+/**
+ * @file pub.c
+ * @author Ilia Proniashin, msg@proglyk.ru
+ * @date 18-October-2026
+ *
+ * Asynchronous publisher implementation.
+ *
+ * Each queue is a ring indexed by free-running head (written by producer)
+ * and tail (written by consumer) counters placed on separate cache lines.
+ * With drop-oldest policy producer also moves tail of full ring by CAS,
+ * so consumer commits its read by CAS and retries if slot was taken away.
+ * With coalesce policy producer never touches tail: frames which don't fit
+ * are parked in per-page pending slots (newer frame replaces older one)
+ * and flushed into the ring on next pushes.
+ */
+
+#include "pub.h"
+
+#if (S2M_USE_PUB)
+
+#if (!S2M_USE_THREADS)
+#error "Macro 'S2M_USE_THREADS' must be enabled if you're using pub.c"
+#endif
+
+#include "alloc.h"
+#include "mms_if.h"
+#include "port_conf.h"
+#include "port_thread.h"
+#include "port_semph.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <string.h>
+
+/** Index mask of ring slot. */
+#define PUB_MASK (PUB_DEPTH - 1)
+
+/** Number of distinct pages. */
+#define PUB_NUM_PAGES \
+  ((SER_MAX_DS_IDX - SER_MIN_DS_IDX + 1) * \
+   (SER_MAX_PAGE_IDX - SER_MIN_PAGE_IDX + 1))
+
+/** Index of page in pending slots. */
+#define PUB_PAGE_KEY(ds, page) \
+  (((ds) - SER_MIN_DS_IDX) * (SER_MAX_PAGE_IDX - SER_MIN_PAGE_IDX + 1) + \
+   ((page) - SER_MIN_PAGE_IDX))
+
+
+/**
+ * Queued page frame.
+ */
+typedef struct {
+  u32_t ts[2];                      // Frame timestamp
+  u8_t ds;                          // Dataset index
+  u8_t page;                        // Page number
+  page_prm_t val[SER_PAGE_SIZE];    // Page values
+} page_item_t;
+
+#if (!S2M_REDUCED)
+/**
+ * Queued subscription frame.
+ */
+typedef struct {
+  u32_t ts[2];                      // Frame timestamp
+  sub_prm_t val[SER_NUM_SUBS];      // Subscription values
+} subs_item_t;
+#endif
+
+/**
+ * Ring indices.
+ */
+typedef struct {
+  atomic_uint head __ALIGNED(PORT_CACHE_LINE);  // Next slot to write
+  atomic_uint tail __ALIGNED(PORT_CACHE_LINE);  // Next slot to read
+} ring_t;
+
+/**
+ * Internal publisher object structure.
+ */
+struct pub_s {
+  ser_t ser;                              // Protocol handler
+  thread_t thread;                        // Publisher thread
+  atomic_bool stop;                       // Thread stop request
+  semph_t wake;                           // Wakes idle thread
+  atomic_bool idle;                       // Thread waits for 'wake'
+  atomic_uint pushed;                     // Statistics
+  atomic_uint dropped;
+  atomic_uint coalesced;
+  ring_t page_q;                          // Page frames queue
+  page_item_t page_buf[PUB_DEPTH];
+#if (!S2M_REDUCED)
+  ring_t subs_q;                          // Subscription frames queue
+  subs_item_t subs_buf[PUB_DEPTH];
+#endif
+#if (S2M_PUB_COALESCE)
+  u32_t page_pend;                        // Bitmap of pending pages
+  page_item_t page_pend_buf[PUB_NUM_PAGES];
+#if (!S2M_REDUCED)
+  bool subs_pend;                         // Pending subscription frame
+  subs_item_t subs_pend_buf;
+#endif
+#endif
+};
+
+STATIC_DECLARE(PUB, struct pub_s);
+
+// Private function declarations
+
+static void *run(void *);
+static bool ring_push(ring_t *, u8_t *, u32_t, const void *);
+static bool ring_pop(ring_t *, const u8_t *, u32_t, void *);
+static void notify(pub_t);
+static bool ring_empty(ring_t *);
+#if (S2M_PUB_COALESCE)
+static bool ring_full(ring_t *);
+static void flush(pub_t);
+#endif
+
+// Public interface function definitions
+
+// Basic functions
+
+/**
+ * Constructor.
+ */
+pub_t pub_new(ser_t ser)
+{
+  assert(ser);
+  ALLOC(PUB, struct pub_s, self, return NULL);
+  self->ser = ser;
+  atomic_init(&self->stop, false);
+  atomic_init(&self->idle, false);
+
+  self->wake = semph_new();
+  if (!self->wake) {
+    printf("[pub_new] Can't create semaphore\n");
+    goto error_0;
+  }
+  self->thread = thread_new((const u8_t *)"s2m-pub", &run, (void *)self, NULL);
+  if (!self->thread) {
+    printf("[pub_new] Can't start publisher thread\n");
+    goto error_1;
+  }
+  return self;
+
+error_1:
+  semph_del(self->wake);
+error_0:
+  FREE(PUB, self);
+  return NULL;
+}
+
+/**
+ * Destructor.
+ */
+void pub_destroy(pub_t self)
+{
+  assert(self);
+  atomic_store(&self->stop, true);
+  semph_post(self->wake);
+  thread_del(self->thread);
+  semph_del(self->wake);
+  FREE(PUB, self);
+}
+
+// Producer side (serial thread)
+
+/**
+ * Queue page values.
+ */
+void pub_push_page(pub_t self, const page_prm_t *buf, u8_t ds, u8_t page)
+{
+  page_item_t item;
+  assert(self && buf);
+
+  mms_if_get_stamp(item.ts);
+  item.ds = ds;
+  item.page = page;
+  memcpy(item.val, buf, sizeof(item.val));
+  atomic_fetch_add_explicit(&self->pushed, 1, memory_order_relaxed);
+
+#if (S2M_PUB_COALESCE)
+  u32_t bit = 1U << PUB_PAGE_KEY(ds, page);
+  flush(self);
+  // Keep order of frames of one page: if older one is parked, park newer
+  if ((self->page_pend & bit) || ring_full(&self->page_q)) {
+    if (self->page_pend & bit) {
+      atomic_fetch_add_explicit(&self->coalesced, 1, memory_order_relaxed);
+    }
+    self->page_pend_buf[PUB_PAGE_KEY(ds, page)] = item;
+    self->page_pend |= bit;
+    notify(self);
+    return;
+  }
+#endif
+  if (ring_push(&self->page_q, (u8_t *)self->page_buf, sizeof(item), &item)) {
+    atomic_fetch_add_explicit(&self->dropped, 1, memory_order_relaxed);
+  }
+  notify(self);
+}
+
+#if (!S2M_REDUCED)
+/**
+ * Queue subscription values.
+ */
+void pub_push_subs(pub_t self, const sub_prm_t *buf)
+{
+  subs_item_t item;
+  assert(self && buf);
+
+  mms_if_get_stamp(item.ts);
+  memcpy(item.val, buf, sizeof(item.val));
+  atomic_fetch_add_explicit(&self->pushed, 1, memory_order_relaxed);
+
+#if (S2M_PUB_COALESCE)
+  flush(self);
+  if (self->subs_pend || ring_full(&self->subs_q)) {
+    if (self->subs_pend) {
+      atomic_fetch_add_explicit(&self->coalesced, 1, memory_order_relaxed);
+    }
+    self->subs_pend_buf = item;
+    self->subs_pend = true;
+    notify(self);
+    return;
+  }
+#endif
+  if (ring_push(&self->subs_q, (u8_t *)self->subs_buf, sizeof(item), &item)) {
+    atomic_fetch_add_explicit(&self->dropped, 1, memory_order_relaxed);
+  }
+  notify(self);
+}
+#endif
+
+// Helper functions
+
+/**
+ * Get publisher statistics.
+ */
+void pub_get_stats(pub_t self, pub_stats_t *stats)
+{
+  assert(self && stats);
+  stats->pushed = atomic_load_explicit(&self->pushed, memory_order_relaxed);
+  stats->dropped = atomic_load_explicit(&self->dropped, memory_order_relaxed);
+  stats->coalesced = atomic_load_explicit(&self->coalesced,
+                                          memory_order_relaxed);
+}
+
+// Private function definitions
+
+/**
+ * Publisher thread function.
+ * Drains subscription queue completely, then applies one page frame.
+ *
+ * @param opaque pointer to publisher object
+ */
+static void *run(void *opaque)
+{
+  pub_t self = (pub_t)opaque;
+  page_item_t page;
+#if (!S2M_REDUCED)
+  subs_item_t subs;
+#endif
+  bool busy;
+  assert(self);
+
+  while (!atomic_load(&self->stop)) {
+    busy = false;
+#if (!S2M_REDUCED)
+    while (ring_pop(&self->subs_q, (const u8_t *)self->subs_buf,
+                    sizeof(subs), &subs)) {
+      mms_if_stamp(subs.ts);
+      ser_apply_subs(self->ser, subs.val);
+      mms_if_unstamp();
+      busy = true;
+    }
+#endif
+    if (ring_pop(&self->page_q, (const u8_t *)self->page_buf,
+                 sizeof(page), &page)) {
+      mms_if_stamp(page.ts);
+      ser_apply_page(self->ser, page.val, page.ds, page.page);
+      mms_if_unstamp();
+      busy = true;
+    }
+    if (busy) continue;
+    // Sleep until producer pushes something: announce it first and check
+    // queues once more, so a push made in between is not missed
+    atomic_store(&self->idle, true);
+    if (!ring_empty(&self->page_q)
+#if (!S2M_REDUCED)
+        || !ring_empty(&self->subs_q)
+#endif
+       ) {
+      atomic_store(&self->idle, false);
+      continue;
+    }
+    semph_wait(self->wake, SEMPH_FOREVER);
+    atomic_store(&self->idle, false);
+  }
+  printf("[run] Caught stop request, exiting...\n");
+  mms_if_release();
+  thread_exit();
+  return NULL;
+}
+
+/**
+ * Wake publisher thread if it sleeps.
+ * Semaphore is posted only on transition to work, so busy consumer costs
+ * producer one atomic exchange.
+ *
+ * @param self pointer to publisher object
+ */
+static void notify(pub_t self)
+{
+  if (atomic_exchange(&self->idle, false)) semph_post(self->wake);
+}
+
+/**
+ * Check if ring has no items.
+ *
+ * @param r ring indices
+ * @return true if ring is empty
+ */
+static bool ring_empty(ring_t *r)
+{
+  return atomic_load_explicit(&r->head, memory_order_acquire) ==
+         atomic_load_explicit(&r->tail, memory_order_acquire);
+}
+
+/**
+ * Put item into ring, dropping the oldest one if ring is full.
+ *
+ * @param r ring indices
+ * @param slots ring slots
+ * @param size size of one slot
+ * @param item item to copy
+ * @return true if oldest item was dropped
+ */
+static bool ring_push(ring_t *r, u8_t *slots, u32_t size, const void *item)
+{
+  bool dropped = false;
+  u32_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+  u32_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+
+  // On failure CAS reloads tail: consumer may have freed the slot itself
+  while ((head - tail) >= PUB_DEPTH) {
+    if (atomic_compare_exchange_weak_explicit(&r->tail, &tail, tail + 1,
+                                              memory_order_acq_rel,
+                                              memory_order_acquire)) {
+      dropped = true;
+      break;
+    }
+  }
+  memcpy(slots + (head & PUB_MASK) * size, item, size);
+  atomic_store_explicit(&r->head, head + 1, memory_order_release);
+  return dropped;
+}
+
+/**
+ * Take item from ring (consumer side).
+ * Read is committed by CAS on tail; if producer dropped the slot while it
+ * was copied, copy is discarded and next slot is read.
+ *
+ * @param r ring indices
+ * @param slots ring slots
+ * @param size size of one slot
+ * @param item pointer to place item
+ * @return true if item was taken, false if ring is empty
+ */
+static bool ring_pop(ring_t *r, const u8_t *slots, u32_t size, void *item)
+{
+  u32_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+  do {
+    if (tail == atomic_load_explicit(&r->head, memory_order_acquire)) {
+      return false;
+    }
+    memcpy(item, slots + (tail & PUB_MASK) * size, size);
+  } while (!atomic_compare_exchange_weak_explicit(&r->tail, &tail, tail + 1,
+                                                  memory_order_acq_rel,
+                                                  memory_order_acquire));
+  return true;
+}
+
+#if (S2M_PUB_COALESCE)
+/**
+ * Check if ring has no free slots (producer side).
+ */
+static bool ring_full(ring_t *r)
+{
+  u32_t head = atomic_load_explicit(&r->head, memory_order_relaxed);
+  u32_t tail = atomic_load_explicit(&r->tail, memory_order_acquire);
+  return (head - tail) >= PUB_DEPTH;
+}
+
+/**
+ * Move parked frames into rings while they have free slots.
+ *
+ * @param self pointer to instance
+ */
+static void flush(pub_t self)
+{
+#if (!S2M_REDUCED)
+  if (self->subs_pend && !ring_full(&self->subs_q)) {
+    ring_push(&self->subs_q, (u8_t *)self->subs_buf,
+              sizeof(self->subs_pend_buf), &self->subs_pend_buf);
+    self->subs_pend = false;
+  }
+#endif
+  for (u32_t key = 0; self->page_pend && (key < PUB_NUM_PAGES); key++) {
+    if (!(self->page_pend & (1U << key))) continue;
+    if (ring_full(&self->page_q)) break;
+    ring_push(&self->page_q, (u8_t *)self->page_buf,
+              sizeof(self->page_pend_buf[key]), &self->page_pend_buf[key]);
+    self->page_pend &= ~(1U << key);
+  }
+}
+#endif
+
+#endif
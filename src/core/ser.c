@@ -9,6 +9,13 @@
 #include "ser.h"
 #include "alloc.h"
 #include "byteops.h"
+#include "mms_if.h"
+#include "map.h"
+#include "pub.h"
+#include "store.h"
+#include "goose.h"
+#include "answ.h"
+#include "port_conf.h"
 #include <assert.h>
 #include <stdio.h>
 #include <string.h>
@@ -20,18 +27,31 @@ struct ser_s {
   ser_cmd_t   cmd_rcvd;                 // Received command: 0 - normal mode,
                                         //                   1 - time transfer
   struct buf_rcvd_s rcvd;               // Receive buffer
-  ser_cmd_t   cmd_xmit;                 // Command to transmit
-  struct buf_xmit_s xmit;               // Transmit buffer
+  // Transmit part starts on its own cache line: in POLL mode it may be
+  // built by another thread while reply is parsed (S2M_USE_SPLIT_RXTX)
+  ser_cmd_t   cmd_xmit __ALIGNED(PORT_CACHE_LINE); // Command to transmit
+  struct buf_xmit_s xmit[2];            // Transmit buffers: sent and next
+  u8_t        xmit_idx;                 // Index of buffer to transmit
   ser_mode_t  mode;                     // Operation mode
   u8_t        ds;                       // Dataset index
   u8_t        page;                     // Page number
-  page_prm_t  page_buf[SER_PAGE_SIZE];  // Page parameters
-#if (!S2M_REDUCED)
-  sub_prm_t   sub_buf[SER_NUM_SUBS];    // Subscription parameters
-#endif
+  u8_t        ds_last;                  // Dataset index before last build
+  u8_t        page_last;                // Page number before last build
   answ_prm_t  answ_buf[SER_ANSW_SIZE];  // Answer parameters
   u32_t       answ_len;                 // Answer length
-  void       *pld_api;                  // Pointer to payload API
+  void       *pld_api;                  // Context of user callbacks
+  ser_ops_t   ops;                      // User callbacks
+  map_t       map;                      // Attribute mapping table
+  answ_t      answ;                     // Precomputed answer
+#if (S2M_USE_PUB)
+  pub_t       pub;                      // Publisher
+#endif
+#if (S2M_USE_STORE)
+  store_t     store;                    // Latest-value store
+#endif
+#if (S2M_USE_GOOSE)
+  goose_t     goose;                    // GOOSE publisher
+#endif
 };
 
 STATIC_DECLARE(SER, struct ser_s);
@@ -41,15 +61,41 @@ STATIC_DECLARE(SER, struct ser_s);
 extern void __WEAK ser2mms_set_time(uint32_t *, uint32_t *);
 extern void __WEAK ser2mms_read_page(const page_prm_t *, u8_t, u8_t, void *);
 extern void __WEAK ser2mms_read_subs(const sub_prm_t *, void *);
+#if (S2M_USE_FRAME_VIEW)
+extern void __WEAK ser2mms_read_frame(const frame_view_t *, void *);
+#endif
 extern void __WEAK ser2mms_write_answer(answ_prm_t *, u32_t *);
 extern void __WEAK ser2mms_write_page(page_prm_t *, u32_t *, u8_t, u8_t);
 extern void __WEAK ser2mms_write_subs(sub_prm_t *, u32_t *);
 
+static void dflt_read_page(const page_prm_t *, u8_t, u8_t, void *);
+static void dflt_read_subs(const sub_prm_t *, void *);
+#if (S2M_USE_FRAME_VIEW)
+static void dflt_read_frame(const frame_view_t *, void *);
+#endif
+static void dflt_write_answer(answ_prm_t *, u32_t *, void *);
+static void dflt_set_time(u32_t *, u32_t *, void *);
+static void dflt_write_page(page_prm_t *, u32_t *, u8_t, u8_t, void *);
+static void dflt_write_subs(sub_prm_t *, u32_t *, void *);
 static s32_t decode_head(ser_t);
 static void encode_head(ser_t);
 static void process_pld(ser_t);
+static void apply_frame(ser_t, const frame_view_t *);
 static void compose_pld(ser_t);
 
+/** Default callbacks: global functions, which user may override. */
+static const ser_ops_t dflt_ops = {
+  .read_page = dflt_read_page,
+  .read_subs = dflt_read_subs,
+#if (S2M_USE_FRAME_VIEW)
+  .read_frame = dflt_read_frame,
+#endif
+  .write_answer = dflt_write_answer,
+  .set_time = dflt_set_time,
+  .write_page = dflt_write_page,
+  .write_subs = dflt_write_subs,
+};
+
 
 // Public interface function definitions
 
@@ -65,6 +111,7 @@ ser_t ser_new(ser_mode_t mode, void *pld_api)
   self->ds = SER_MAX_DS_IDX;
   self->page = SER_MAX_PAGE_IDX;
   self->pld_api = pld_api;
+  self->ops = dflt_ops;
   return self;
 }
 
@@ -113,6 +160,52 @@ void ser_out_build(ser_t self)
   compose_pld(self);
 }
 
+/**
+* Drop built outgoing message.
+*/
+void ser_out_drop(ser_t self)
+{
+  assert(self);
+  if (self->mode != MODE_POLL) return;
+  self->ds = self->ds_last;
+  self->page = self->page_last;
+}
+
+/**
+* Build speculative reply.
+*/
+bool ser_out_spec(ser_t self, u32_t *ver)
+{
+  assert(self && ver);
+  if ((self->mode != MODE_SLAVE) || !self->answ) return false;
+
+  buf_xmit_t pbuf = GET_NEXT(self);
+  // Version is taken before block, so update in between invalidates reply
+  *ver = answ_get_ver(self->answ);
+  S_TO_PB((pbuf->buf + pbuf->size), CMD_PARAMETERS);
+  pbuf->size += 2;
+  pbuf->size += answ_read(self->answ, pbuf->buf + pbuf->size);
+  return true;
+}
+
+/**
+* Check speculative reply.
+*/
+bool ser_spec_valid(ser_t self, u32_t ver)
+{
+  assert(self);
+  return self->answ && (answ_get_ver(self->answ) == ver);
+}
+
+/**
+* Check speculative reply against received request.
+*/
+bool ser_spec_hit(ser_t self, u32_t ver)
+{
+  assert(self);
+  return (self->cmd_rcvd == CMD_PARAMETERS) && ser_spec_valid(self, ver);
+}
+
 // Helper functions
 
 /**
@@ -124,6 +217,108 @@ void ser_set_cmd(ser_t self, u32_t value)
   self->cmd_xmit = value ? CMD_TIMESET : CMD_PARAMETERS;
 }
 
+/**
+* Set attribute mapping table.
+*/
+void ser_set_map(ser_t self, ser_map_t map)
+{
+  assert(self);
+  self->map = map;
+}
+
+#if (S2M_USE_PUB)
+/**
+* Set publisher.
+*/
+void ser_set_pub(ser_t self, ser_pub_t pub)
+{
+  assert(self);
+  self->pub = pub;
+}
+#endif
+
+#if (S2M_USE_STORE)
+/**
+* Set latest-value store.
+*/
+void ser_set_store(ser_t self, ser_store_t store)
+{
+  assert(self);
+  self->store = store;
+}
+#endif
+
+#if (S2M_USE_GOOSE)
+/**
+* Set GOOSE publisher.
+*/
+void ser_set_goose(ser_t self, ser_goose_t goose)
+{
+  assert(self);
+  self->goose = goose;
+}
+#endif
+
+/**
+* Set user callbacks.
+*/
+void ser_set_ops(ser_t self, const ser_ops_t *ops, void *ctx)
+{
+  assert(self);
+  if (ctx) self->pld_api = ctx;
+  self->ops = dflt_ops;
+  if (!ops) return;
+  // Missing members keep defaults, so calls need no checks
+  if (ops->read_page) self->ops.read_page = ops->read_page;
+  if (ops->read_subs) self->ops.read_subs = ops->read_subs;
+#if (S2M_USE_FRAME_VIEW)
+  if (ops->read_frame) self->ops.read_frame = ops->read_frame;
+#endif
+  if (ops->write_answer) self->ops.write_answer = ops->write_answer;
+  if (ops->set_time) self->ops.set_time = ops->set_time;
+  if (ops->write_page) self->ops.write_page = ops->write_page;
+  if (ops->write_subs) self->ops.write_subs = ops->write_subs;
+}
+
+/**
+* Set precomputed answer.
+*/
+void ser_set_answ(ser_t self, ser_answ_t answ)
+{
+  assert(self);
+  self->answ = answ;
+}
+
+// Applying received values
+
+/**
+* Apply page values.
+*/
+void ser_apply_page(ser_t self, const page_prm_t *buf, u8_t ds, u8_t page)
+{
+  assert(self && buf);
+  if (self->map) {
+    map_apply_page(self->map, buf, ds, page);
+  } else {
+    self->ops.read_page(buf, ds, page, self->pld_api);
+  }
+}
+
+#if (!S2M_REDUCED)
+/**
+* Apply subscription values.
+*/
+void ser_apply_subs(ser_t self, const sub_prm_t *buf)
+{
+  assert(self && buf);
+  if (self->map) {
+    map_apply_subs(self->map, buf);
+  } else {
+    self->ops.read_subs(buf, self->pld_api);
+  }
+}
+#endif
+
 /**
 * Get pointer to receive buffer.
 */
@@ -139,7 +334,25 @@ buf_rcvd_t ser_get_buf_rcvd(ser_t self)
 buf_xmit_t ser_get_buf_xmit(ser_t self)
 {
   assert(self);
-  return &self->xmit;
+  return &self->xmit[self->xmit_idx];
+}
+
+/**
+* Get pointer to buffer of next message.
+*/
+buf_xmit_t ser_get_buf_next(ser_t self)
+{
+  assert(self);
+  return &self->xmit[self->xmit_idx ^ 1];
+}
+
+/**
+* Swap transmit buffers.
+*/
+void ser_flip_xmit(ser_t self)
+{
+  assert(self);
+  self->xmit_idx ^= 1;
 }
 
 // Private function definitions
@@ -224,34 +437,91 @@ static void process_pld(ser_t self)
 
     case MODE_SLAVE:
     {
-      // Place data from input buffer into temporary buffer.
-      // Later the temporary buffer should be replaced with real variables. These
-      // variables will represent DataSet fields 1 to 6 for ice loads.
-      for (u32_t i=0; i<SER_PAGE_SIZE; i++) {
-        self->page_buf[i].mag = B_TO_S(buf[*pos], buf[*pos+1]);
-        *pos += 2;
+      // Take frame timestamp once, it is shared by all attributes below
+      mms_if_stamp(NULL);
+
+      // Payload stays in receive buffer, values are decoded from it only
+      // by consumers which need them
+      frame_view_t frm = {
+        .pld = buf + *pos, .ds = self->ds, .page = self->page
+      };
+      *pos += SER_FRAME_PLD_SIZE;
+#if (S2M_USE_GOOSE) && (!S2M_REDUCED)
+      // Fast path: publish before anything is written to data model
+      if (self->goose) {
+        goose_publish(self->goose, &frm, self->rcvd.ts);
       }
-      // Call function to update dataset fields
-      ser2mms_read_page((const page_prm_t *)self->page_buf,
-                        self->ds, self->page, self->pld_api);
+#endif
+      apply_frame(self, &frm);
+      mms_if_unstamp();
+    } break;
+  }
+}
 
-      // Fill structure fields with values from buffer
-      // Parameter [0..10]
+/**
+* Apply values of received frame.
+* Values are decoded into arrays only for mapping table, publisher/flusher
+* thread and ser2mms_read_page/ser2mms_read_subs.
+*/
+static void apply_frame(ser_t self, const frame_view_t *frm)
+{
+  page_prm_t page_buf[SER_PAGE_SIZE];
 #if (!S2M_REDUCED)
-      for (u32_t i=0; i<SER_NUM_SUBS; i++) {
-        self->sub_buf[i].mag = B_TO_S(buf[*pos], buf[*pos+1]);
-        *pos += 2;
-        self->sub_buf[i].t[0] = B_TO_L(buf[*pos+0], buf[*pos+1], buf[*pos+2],
-                                       buf[*pos+3]);
-        *pos += 4;
-        self->sub_buf[i].t[1] = (s16_t)B_TO_S(buf[*pos], buf[*pos+1]) * 1000U;
-        *pos += 2;
-      }
-      // Iterate over all 11 fields
-      ser2mms_read_subs((const sub_prm_t *)self->sub_buf, self->pld_api);
+  sub_prm_t sub_buf[SER_NUM_SUBS];
 #endif
-    } break;
+  assert(self && frm);
+
+#if (S2M_USE_FRAME_VIEW)
+  // User reads only values it needs straight from the frame
+  bool direct = !self->map;
+#if (S2M_USE_PUB)
+  direct = direct && !self->pub;
+#endif
+#if (S2M_USE_STORE)
+  direct = direct && !self->store;
+#endif
+  if (direct) {
+    self->ops.read_frame(frm, self->pld_api);
+    return;
   }
+#endif
+
+  for (u32_t i=0; i<SER_PAGE_SIZE; i++) {
+    page_buf[i].mag = frame_page(frm, i);
+  }
+  // Update dataset fields here or in publisher/flusher thread
+#if (S2M_USE_PUB)
+  if (self->pub) {
+    pub_push_page(self->pub, (const page_prm_t *)page_buf,
+                  frm->ds, frm->page);
+  } else
+#endif
+#if (S2M_USE_STORE)
+  if (self->store) {
+    store_put_page(self->store, (const page_prm_t *)page_buf,
+                   frm->ds, frm->page);
+  } else
+#endif
+  ser_apply_page(self, (const page_prm_t *)page_buf, frm->ds, frm->page);
+
+  // Parameter [0..10]
+#if (!S2M_REDUCED)
+  for (u32_t i=0; i<SER_NUM_SUBS; i++) {
+    sub_buf[i].mag = frame_mag(frm, i);
+    frame_ts(frm, i, sub_buf[i].t);
+  }
+#if (S2M_USE_PUB)
+  if (self->pub) {
+    pub_push_subs(self->pub, (const sub_prm_t *)sub_buf);
+  } else
+#endif
+#if (S2M_USE_STORE)
+  if (self->store) {
+    store_put_subs(self->store, (const sub_prm_t *)sub_buf);
+  } else
+#endif
+  ser_apply_subs(self, (const sub_prm_t *)sub_buf);
+#endif
 }
 
 /**
@@ -263,13 +533,15 @@ static void encode_head(ser_t self)
   u8_t *buf;
   u32_t *size;
   assert(self);
-  buf = self->xmit.buf;
-  size = &self->xmit.size;
+  buf = GET_NEXT(self)->buf;
+  size = &GET_NEXT(self)->size;
 
   switch (self->mode)
   {
     case MODE_POLL:
     {
+      self->ds_last = self->ds;
+      self->page_last = self->page;
       if (self->page >= SER_MAX_PAGE_IDX) self->page = SER_MIN_PAGE_IDX;
       else self->page += 1;
 
@@ -307,37 +579,41 @@ static void compose_pld(ser_t self)
   u8_t *buf;
   u32_t *size;
   uint32_t ts[2];
+  page_prm_t page_buf[SER_PAGE_SIZE];
+#if (!S2M_REDUCED)
+  sub_prm_t sub_buf[SER_NUM_SUBS];
+#endif
   assert(self);
-  buf = self->xmit.buf;
-  size = &self->xmit.size;
+  buf = GET_NEXT(self)->buf;
+  size = &GET_NEXT(self)->size;
 
   switch (self->mode)
   {
     case MODE_POLL:
     {
       // Call function to write current page fields
-      ser2mms_write_page(self->page_buf, &buf_len,
-                         self->ds, self->page);
+      self->ops.write_page(page_buf, &buf_len, self->ds, self->page,
+                           self->pld_api);
       // Check array size
       if (buf_len > SER_PAGE_SIZE) { return; }
       // Iterate over current page
       for (u32_t i=0; i<buf_len; i++) {
-        S_TO_PB(buf+*size, self->page_buf[i].mag);
+        S_TO_PB(buf+*size, page_buf[i].mag);
         *size += 2;
       }
 
 #if (!S2M_REDUCED)
       // Call function to write subscription fields
-      ser2mms_write_subs(self->sub_buf, &buf_len);
+      self->ops.write_subs(sub_buf, &buf_len, self->pld_api);
       // Check array size
       if (buf_len > SER_NUM_SUBS) { return; }
       // Iterate over subscriptions
       for (u32_t i=0; i<buf_len; i++) {
-        S_TO_PB(buf+*size, self->sub_buf[i].mag);
+        S_TO_PB(buf+*size, sub_buf[i].mag);
         *size += 2;
-        I_TO_PB(buf+*size, self->sub_buf[i].t[0]);
+        I_TO_PB(buf+*size, sub_buf[i].t[0]);
         *size += 4;
-        S_TO_PB(buf+*size, self->sub_buf[i].t[1]);
+        S_TO_PB(buf+*size, sub_buf[i].t[1]);
         *size += 2;
       }
 #endif
@@ -346,10 +622,16 @@ static void compose_pld(ser_t self)
     case MODE_SLAVE:
     {
       // Command: parameter transfer
-      if (self->cmd_rcvd == CMD_PARAMETERS)
+      if ((self->cmd_rcvd == CMD_PARAMETERS) && self->answ)
+      {
+        // Copy encoded block kept up to date by write handlers
+        *size += answ_read(self->answ, buf+*size);
+      }
+      else if (self->cmd_rcvd == CMD_PARAMETERS)
       {
         // Call functor to get values into 'answ_buf'
-        ser2mms_write_answer(self->answ_buf, &self->answ_len);
+        self->ops.write_answer(self->answ_buf, &self->answ_len,
+                              self->pld_api);
         // Check array size
         if (self->answ_len > SER_ANSW_SIZE) { return; }
         // Iterate over all 'answ_buf' values
@@ -362,7 +644,7 @@ static void compose_pld(ser_t self)
       else if (self->cmd_rcvd == CMD_TIMESET)
       {
         // Set time externally
-        ser2mms_set_time(&ts[0], &ts[1]);
+        self->ops.set_time(&ts[0], &ts[1], self->pld_api);
         // Iterate over 'ts' fields
         I_TO_PB(buf+*size, ts[0]);
         *size += 4;
@@ -372,3 +654,49 @@ static void compose_pld(ser_t self)
     } break;
   }
 }
+
+/**
+* Default callbacks.
+* Global functions don't get context except read handlers, which get
+* payload API context (ser2mms object) as before.
+*/
+static void dflt_read_page(const page_prm_t *buf, u8_t ds, u8_t page,
+                           void *ctx)
+{
+  ser2mms_read_page(buf, ds, page, ctx);
+}
+
+static void dflt_read_subs(const sub_prm_t *buf, void *ctx)
+{
+  ser2mms_read_subs(buf, ctx);
+}
+
+#if (S2M_USE_FRAME_VIEW)
+static void dflt_read_frame(const frame_view_t *frm, void *ctx)
+{
+  ser2mms_read_frame(frm, ctx);
+}
+#endif
+
+static void dflt_write_answer(answ_prm_t *buf, u32_t *buf_len,
+                              __UNUSED void *ctx)
+{
+  ser2mms_write_answer(buf, buf_len);
+}
+
+static void dflt_set_time(u32_t *epoch, u32_t *usec, __UNUSED void *ctx)
+{
+  ser2mms_set_time(epoch, usec);
+}
+
+static void dflt_write_page(page_prm_t *buf, u32_t *buf_len, u8_t ds,
+                            u8_t page, __UNUSED void *ctx)
+{
+  ser2mms_write_page(buf, buf_len, ds, page);
+}
+
+static void dflt_write_subs(sub_prm_t *buf, u32_t *buf_len,
+                            __UNUSED void *ctx)
+{
+  ser2mms_write_subs(buf, buf_len);
+}
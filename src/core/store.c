@@ -0,0 +1,228 @@
+/**
+ * @file store.c
+ * @author Ilia Proniashin, msg@proglyk.ru
+ * @date 18-October-2026
+ *
+ * Latest-value store implementation.
+ *
+ * Every slot is guarded by sequence counter (seqlock) with single writer:
+ * the counter is odd while slot is written. Dirty bit is set after slot is
+ * written and is cleared by flusher before slot is read, so a value
+ * written during flush is committed on the next one and never lost.
+ */
+
+#include "store.h"
+
+#if (S2M_USE_STORE)
+
+#if (!S2M_USE_THREADS)
+#error "Macro 'S2M_USE_THREADS' must be enabled if you're using store.c"
+#endif
+
+#include "alloc.h"
+#include "mms_if.h"
+#include "port_conf.h"
+#include "port_thread.h"
+#include <assert.h>
+#include <stdatomic.h>
+#include <stdio.h>
+
+/** Number of bits in dirty bitmap word. */
+#define STORE_WORD_BITS (32)
+
+/** Number of dirty bitmap words. */
+#define STORE_NUM_WORDS ((MAP_NUM_ENTS + STORE_WORD_BITS - 1) / STORE_WORD_BITS)
+
+/**
+ * Last value of one point.
+ */
+typedef struct {
+  atomic_uint seq;  // Sequence counter, odd while slot is written
+  s16_t raw;        // Raw value from frame
+  bool ext;         // Timestamp is external (subscription value)
+  u32_t ts[2];      // Timestamp
+} slot_t;
+
+/**
+ * Internal store object structure.
+ */
+struct store_s {
+  map_t map;                                        // Mapping table
+  thread_t thread;                                  // Flusher thread
+  atomic_bool stop;                                 // Thread stop request
+  atomic_uint dirty[STORE_NUM_WORDS] __ALIGNED(PORT_CACHE_LINE);
+  slot_t slot[MAP_NUM_ENTS] __ALIGNED(PORT_CACHE_LINE);
+};
+
+STATIC_DECLARE(STORE, struct store_s);
+
+// Private function declarations
+
+static void *run(void *);
+static void put(store_t, u32_t, s16_t, const u32_t *, bool);
+static void get(store_t, u32_t, slot_t *);
+
+// Public interface function definitions
+
+// Basic functions
+
+/**
+ * Constructor.
+ */
+store_t store_new(map_t map)
+{
+  assert(map);
+  ALLOC(STORE, struct store_s, self, return NULL);
+  self->map = map;
+  atomic_init(&self->stop, false);
+
+  self->thread = thread_new((const u8_t *)"s2m-store", &run, (void *)self, NULL);
+  if (!self->thread) {
+    printf("[store_new] Can't start flusher thread\n");
+    FREE(STORE, self);
+    return NULL;
+  }
+  return self;
+}
+
+/**
+ * Destructor.
+ */
+void store_destroy(store_t self)
+{
+  assert(self);
+  atomic_store(&self->stop, true);
+  thread_del(self->thread);
+  store_flush(self);
+  FREE(STORE, self);
+}
+
+// Writer side (serial thread)
+
+/**
+ * Store page values.
+ */
+void store_put_page(store_t self, const page_prm_t *buf, u8_t ds, u8_t page)
+{
+  u32_t ts[2];
+  assert(self && buf);
+  mms_if_get_stamp(ts);
+  u32_t idx = MAP_PAGE_IDX(ds, page, 0);
+  for (u32_t i=0; i<SER_PAGE_SIZE; i++) {
+    put(self, idx + i, buf[i].mag, ts, false);
+  }
+}
+
+/**
+ * Store subscription values.
+ */
+void store_put_subs(store_t self, const sub_prm_t *buf)
+{
+  assert(self && buf);
+  u32_t idx = MAP_SUB_IDX(0);
+  for (u32_t i=0; i<MAP_NUM_SUBS; i++) {
+    put(self, idx + i, buf[i].mag, buf[i].t, true);
+  }
+}
+
+// Committing values
+
+/**
+ * Commit dirty points.
+ */
+u32_t store_flush(store_t self)
+{
+  slot_t val;
+  u32_t cnt = 0;
+  assert(self);
+
+  for (u32_t w=0; w<STORE_NUM_WORDS; w++) {
+    // Take and clear dirty bits of word before reading slots
+    u32_t bits = atomic_exchange_explicit(&self->dirty[w], 0,
+                                          memory_order_acquire);
+    for (u32_t b=0; bits; b++, bits >>= 1) {
+      if (!(bits & 1U)) continue;
+      u32_t idx = w * STORE_WORD_BITS + b;
+      get(self, idx, &val);
+      mms_if_stamp(val.ts);
+      map_apply_point(self->map, idx, val.raw, val.ext ? val.ts : NULL);
+      mms_if_unstamp();
+      cnt++;
+    }
+  }
+  return cnt;
+}
+
+// Private function definitions
+
+/**
+ * Flusher thread function.
+ *
+ * @param opaque pointer to store object
+ */
+static void *run(void *opaque)
+{
+  store_t self = (store_t)opaque;
+  assert(self);
+
+  while (!atomic_load(&self->stop)) {
+    store_flush(self);
+    thread_sleep(STORE_FLUSH_MS);
+  }
+  printf("[run] Caught stop request, exiting...\n");
+  mms_if_release();
+  thread_exit();
+  return NULL;
+}
+
+/**
+ * Write slot and mark it dirty (single writer).
+ *
+ * @param self pointer to instance
+ * @param idx flat index of point
+ * @param raw raw value
+ * @param ts timestamp
+ * @param ext timestamp is external
+ */
+static void put(store_t self, u32_t idx, s16_t raw, const u32_t *ts, bool ext)
+{
+  slot_t *s = &self->slot[idx];
+  u32_t seq = atomic_load_explicit(&s->seq, memory_order_relaxed);
+
+  atomic_store_explicit(&s->seq, seq + 1, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+  s->raw = raw;
+  s->ext = ext;
+  s->ts[0] = ts[0];
+  s->ts[1] = ts[1];
+  atomic_store_explicit(&s->seq, seq + 2, memory_order_release);
+
+  atomic_fetch_or_explicit(&self->dirty[idx / STORE_WORD_BITS],
+                           1U << (idx % STORE_WORD_BITS),
+                           memory_order_release);
+}
+
+/**
+ * Read consistent copy of slot.
+ *
+ * @param self pointer to instance
+ * @param idx flat index of point
+ * @param val pointer to place copy
+ */
+static void get(store_t self, u32_t idx, slot_t *val)
+{
+  const slot_t *s = &self->slot[idx];
+  u32_t seq0, seq1;
+
+  do {
+    seq0 = atomic_load_explicit(&s->seq, memory_order_acquire);
+    val->raw = s->raw;
+    val->ext = s->ext;
+    val->ts[0] = s->ts[0];
+    val->ts[1] = s->ts[1];
+    atomic_thread_fence(memory_order_acquire);
+    seq1 = atomic_load_explicit(&s->seq, memory_order_relaxed);
+  } while ((seq0 & 1U) || (seq0 != seq1));
+}
+
+#endif
@@ -11,8 +11,10 @@
 #include "event.h"
 #include "byteops.h"
 #include "ser.h"
+#include "pt.h"
 #include "port_tmr.h"
 #include "port_rs485.h"
+#include "port_conf.h"
 #include <stdio.h>
 #include <assert.h>
 #include <string.h>
@@ -20,6 +22,15 @@
 
 #if (S2M_USE_TRANSP_RTU)
 
+/** Time to block on events if port can't wait for line and events at once, ms. */
+#define TRANSP_EV_WAIT_MS (1)
+
+/** Time to wait for line if port can't be woken by events, us. */
+#define TRANSP_RX_WAIT_US (250)
+
+/** Time to block on events in transmit thread (split mode), ms. */
+#define TRANSP_TX_WAIT_MS (10)
+
 /** Receiver states. */
 typedef enum {
   RECV_INIT,  // Initialization
@@ -39,13 +50,37 @@ typedef enum {
 struct transp_s
 {
   rs485_t stty;        // RS485 interface
-  recv_sta_t recv_sta; // Receiver state
-  xmit_sta_t xmit_sta; // Transmitter state
-  ev_t ev_rcvd;        // Receive event
-  ev_t ev_xmit;        // Transmit event
-  u32_t id;            // Device address identifier
   ser_t ser;           // Serial protocol handler
   ser_mode_t mode;     // Operation mode
+  bool split;          // Receive and transmit run in separate threads
+  bool ev_wake;        // Receive queue interrupts waiting for line
+  bool rx_irq;         // Port hands bytes over from interrupt, no descriptor
+  // Receive part (receive thread in split mode)
+  recv_sta_t recv_sta __ALIGNED(PORT_CACHE_LINE); // Receiver state
+  u64_t rx_us;         // Time of last received bytes, us
+  u32_t gap_us;        // Silence that ends partly received frame, us
+  ev_t ev_rx;          // Receive event queue (same as 'ev' if not split)
+  // Transmit part (transmit thread in split mode)
+  xmit_sta_t xmit_sta __ALIGNED(PORT_CACHE_LINE); // Transmitter state
+  bool xmit_ready;     // Next message is already built
+  pt_t pt;             // Request/reply session (POLL)
+  bool req;            // Request is due (timer or user)
+  bool rsp;            // Reply to current request accepted
+  bool rsp_wait;       // Waiting for reply
+  u64_t rsp_end;       // Reply deadline, us
+  u32_t retry;         // Repeats of current request
+  u32_t rsp_lost;      // Requests left without reply
+  u32_t spec_ver;      // Answer version of prebuilt reply (SLAVE)
+#if (S2M_DUP_WINDOW_MS)
+  // Last accepted request, its reply is still in transmit buffer (SLAVE)
+  u8_t dup_buf[BUFSIZE];
+  u32_t dup_size;      // Size of request, 0 - none
+  u16_t dup_crc;       // CRC of request
+  u64_t dup_us;        // Time request was accepted, us
+  u32_t dup_hits;      // Retries answered from cache
+#endif
+  ev_t ev;             // Event queue (transmit, control)
+  u32_t id;            // Device address identifier
 };
 
 STATIC_DECLARE(TRANSP, struct transp_s);
@@ -55,8 +90,23 @@ extern u16_t crc16(const u8_t *, u16_t);
 
 static void recv_impl(void *, u32_t);
 static void xmit_impl(void *);
+static s32_t msg_check(transp_t *tp);
 static s32_t msg_unpack(transp_t *tp);
 static void msg_pack(transp_t *tp);
+static void msg_send(transp_t *tp);
+static void msg_spec(transp_t *tp);
+static void msg_crc(buf_xmit_t pbuf);
+static void msg_xmit(transp_t *tp);
+#if (S2M_DUP_WINDOW_MS)
+static bool dup_find(transp_t *tp);
+static void dup_save(transp_t *tp);
+#endif
+static void handle(transp_t *tp, const ev_msg_t *msg);
+static void dispatch(transp_t *tp, ev_t ev, u32_t wait);
+static void expire(transp_t *tp);
+static PT_THREAD(session(transp_t *tp));
+static s32_t left_ms(u64_t end);
+static s32_t gap_left(transp_t *tp);
 
 // Public interface function definitions
 
@@ -72,8 +122,10 @@ void *transp_new(__UNUSED int argc, __UNUSED int *pdata, __UNUSED void *argv,
 
   self->id = id;
   self->mode = mode;
+  self->split = S2M_USE_SPLIT_RXTX && (mode == MODE_POLL);
   self->recv_sta = RECV_INIT;
   self->xmit_sta = XMIT_INIT;
+  PT_INIT(&self->pt);
 
   // RS485 initialization
   rs485_fn_t fn_s = {
@@ -84,13 +136,23 @@ void *transp_new(__UNUSED int argc, __UNUSED int *pdata, __UNUSED void *argv,
     printf("[transp_init] rs485_new() returned FAIL\n");
     goto error_0;
   }
+  // Frame gap follows line rate, but not below OS latency
+  self->gap_us = rs485_get_char_us(self->stty) * S2M_RX_GAP_CHARS;
+  if (self->gap_us < S2M_RX_GAP_MS * 1000) self->gap_us = S2M_RX_GAP_MS * 1000;
 
   // Event initialization
-  self->ev_rcvd = ev_new();
-  if (!self->ev_rcvd) goto error_1;
+  self->ev = ev_new();
+  if (!self->ev) goto error_1;
 
-  self->ev_xmit = ev_new();
-  if (!self->ev_xmit) goto error_2;
+  self->ev_rx = self->split ? ev_new() : self->ev;
+  if (!self->ev_rx) goto error_2;
+
+  // Receiver sleeps until data or event (if port supports it)
+  fd_t fd = ev_get_fd(self->ev_rx);
+  self->ev_wake = (fd >= 0) && rs485_set_wake(self->stty, fd);
+  // Port without descriptor calls receive handler from its interrupt, which
+  // wakes receive queue, so there is nothing to wait for in port
+  self->rx_irq = EV_USE_THREADS && (rs485_get_fd(self->stty) < 0);
 
   // Upper layer initialization
   self->ser = ser_new(mode, pld_api);
@@ -99,8 +161,8 @@ void *transp_new(__UNUSED int argc, __UNUSED int *pdata, __UNUSED void *argv,
   return (void *)self;
 
   // Cleanup created objects on error
-error_3: ev_destroy(self->ev_xmit);
-error_2: ev_destroy(self->ev_rcvd);
+error_3: if (self->split) ev_destroy(self->ev_rx);
+error_2: ev_destroy(self->ev);
 error_1: rs485_del(self->stty);
 error_0: FREE(TRANSP, self);
   return NULL;
@@ -115,8 +177,8 @@ void transp_destroy(__UNUSED int argc, void *opaque)
   assert(self);
 
   rs485_del(self->stty);
-  ev_destroy(self->ev_rcvd);
-  ev_destroy(self->ev_xmit);
+  if (self->split) ev_destroy(self->ev_rx);
+  ev_destroy(self->ev);
   ser_destroy(self->ser);
   FREE(TRANSP, self);
 }
@@ -136,51 +198,114 @@ void transp_run(transp_t *self)
  */
 int transp_poll(transp_t *tp)
 {
-  ev_type_t type;
+  transp_poll_rx(tp);
+  if (tp->split) dispatch(tp, tp->ev, 0);
+  session(tp);
+  // Keep reply ready for the next request while line is idle
+  msg_spec(tp);
+  return 0;
+}
+
+/**
+ * Poll receive part.
+ */
+int transp_poll_rx(transp_t *tp)
+{
+  // Reply deadline is owned by transmit thread in split mode, there it
+  // wakes receive thread through 'ev_rx' instead
+  s32_t tmo = tp->split ? gap_left(tp) : transp_get_timeout(tp);
+
+  if (tp->rx_irq) {
+    // Queue is woken by the first byte of frame and by complete frame,
+    // so only the frame gap or reply deadline bounds the wait
+    dispatch(tp, tp->ev_rx, (tmo < 0) ? EV_FOREVER : (u32_t)tmo);
+    expire(tp);
+    return 0;
+  }
+
+  // Sleep in port until bytes or event arrive, but not past frame gap
+  u32_t wait_us = tp->ev_wake ? PORT_RS485_RX_WAIT * 1000 : TRANSP_RX_WAIT_US;
+  if ((tmo >= 0) && ((u32_t)tmo * 1000 < wait_us)) wait_us = (u32_t)tmo * 1000;
 
   // Poll RS485 receiver
-  rs485_poll_rx(tp->stty);
+  rs485_poll_rx(tp->stty, wait_us);
 
-  // Process events depending on mode
-  switch (tp->mode)
-  {
-    case MODE_SLAVE: {
-      // Receive event (message from master)
-      if (ev_get(tp->ev_rcvd, &type)) {
-        if (type == EV_RCVD) {
-          tp->recv_sta = RECV_IDLE;
-          if (msg_unpack(tp) == 0) {
-            msg_pack(tp);
-            tp->xmit_sta = XMIT_ACT;
-            rs485_ena(tp->stty, false, true);
-            rs485_poll_tx(tp->stty);
-          }
-        }
-      }
-    } break;
+  // Block on events only if receiver doesn't sleep itself
+  dispatch(tp, tp->ev_rx, tp->ev_wake ? 0 : TRANSP_EV_WAIT_MS);
+  expire(tp);
+  return 0;
+}
 
-    case MODE_POLL: {
-      // Receive event (response message from slave)
-      if (ev_get(tp->ev_rcvd, &type)) {
-        if (type == EV_RCVD) {
-          msg_unpack(tp);
-        }
-      }
+/**
+ * Poll transmit part.
+ */
+int transp_poll_tx(transp_t *tp)
+{
+  assert(tp);
+  // Don't sleep past reply deadline
+  s32_t tmo = tp->rsp_wait ? left_ms(tp->rsp_end) : -1;
+  dispatch(tp, tp->ev, ((tmo >= 0) && (tmo < TRANSP_TX_WAIT_MS)) ?
+                       (u32_t)tmo : TRANSP_TX_WAIT_MS);
+  session(tp);
+  return 0;
+}
 
-      // Transmit event (command from user)
-      if (ev_get(tp->ev_xmit, &type)) {
-        if (type == EV_SENT) {
-          msg_pack(tp);
-          tp->xmit_sta = XMIT_ACT;
-          rs485_ena(tp->stty, false, true);
-        }
-      }
-    } break;
-  }
+/**
+ * Check split mode.
+ */
+bool transp_is_split(transp_t *tp)
+{
+  assert(tp);
+  return tp->split;
+}
 
+/**
+ * Process ready descriptors without blocking.
+ */
+int transp_process(transp_t *tp, bool rx_ready)
+{
+  assert(tp);
+  if (rx_ready) rs485_poll_rx(tp->stty, 0);
+  dispatch(tp, tp->ev_rx, 0);
+  if (tp->split) dispatch(tp, tp->ev, 0);
+  expire(tp);
+  session(tp);
+  msg_spec(tp);
   return 0;
 }
 
+/**
+ * Get descriptors to wait for.
+ */
+u32_t transp_get_fds(transp_t *tp, fd_t *fds, u32_t max)
+{
+  u32_t cnt = 0;
+  assert(tp && fds);
+  fd_t fd[3] = {
+    rs485_get_fd(tp->stty), ev_get_fd(tp->ev),
+    tp->split ? ev_get_fd(tp->ev_rx) : -1
+  };
+
+  for (u32_t i=0; i<3; i++) {
+    if ((fd[i] >= 0) && (cnt < max)) fds[cnt++] = fd[i];
+  }
+  return cnt;
+}
+
+/**
+ * Get time to next deadline.
+ */
+s32_t transp_get_timeout(transp_t *tp)
+{
+  assert(tp);
+  s32_t gap = gap_left(tp);
+  s32_t rsp = tp->rsp_wait ? left_ms(tp->rsp_end) : -1;
+
+  if (gap < 0) return rsp;
+  if (rsp < 0) return gap;
+  return (gap < rsp) ? gap : rsp;
+}
+
 // Helper functions
 
 /**
@@ -189,7 +314,26 @@ int transp_poll(transp_t *tp)
 void transp_tick(transp_t *self)
 {
   assert(self);
-  ev_post(self->ev_xmit, EV_SENT);
+  ev_post(self->ev, EV_SENT, 0);
+}
+
+/**
+ * Interrupt waiting in transp_poll().
+ */
+void transp_wake(transp_t *self)
+{
+  assert(self);
+  ev_wake(self->ev);
+  if (self->split) ev_wake(self->ev_rx);
+}
+
+/**
+ * Request command change.
+ */
+void transp_exec(transp_t *self, u32_t cmd)
+{
+  assert(self);
+  ev_post(self->ev, EV_EXEC, cmd);
 }
 
 /**
@@ -225,11 +369,243 @@ void *transp_get_top(transp_t *self)
 void transp_set_id(transp_t *self, u32_t id)
 {
   assert(self);
-  self->id = id;
+  // Address is put into frames by the thread handling 'ev'
+  ev_post(self->ev, EV_ADDR, id);
+}
+
+/**
+ * Getter for number of lost events.
+ */
+u32_t transp_get_ev_lost(transp_t *self)
+{
+  assert(self);
+  return ev_get_lost(self->ev);
+}
+
+/**
+ * Getter for number of requests left without reply.
+ */
+u32_t transp_get_rsp_lost(transp_t *self)
+{
+  assert(self);
+  return self->rsp_lost;
+}
+
+/**
+ * Getter for number of retries answered from cache.
+ */
+u32_t transp_get_dup_hits(transp_t *self)
+{
+  assert(self);
+#if (S2M_DUP_WINDOW_MS)
+  return self->dup_hits;
+#else
+  return 0;
+#endif
+}
+
+/**
+ * Getter for receive statistics.
+ */
+void transp_get_rx_stats(transp_t *self, rs485_stats_t *stats)
+{
+  assert(self && stats);
+  rs485_get_stats(self->stty, stats);
 }
 
 // Private function definitions
 
+// Event handling
+
+/**
+ * Handle event depending on mode.
+ */
+static void handle(transp_t *tp, const ev_msg_t *msg)
+{
+  switch (msg->type)
+  {
+    case EV_RCVD: {
+      // Message from master: reply to it
+      if (tp->mode == MODE_SLAVE) {
+        tp->recv_sta = RECV_IDLE;
+        if (msg_check(tp) < 0) break;
+#if (S2M_DUP_WINDOW_MS)
+        // Retry of the last request: reply again without parsing it
+        if (dup_find(tp)) {
+          tp->dup_hits++;
+          msg_xmit(tp);
+          break;
+        }
+#endif
+        if (ser_in_parse(tp->ser) < 0) {
+          printf("[handle] failed to parse message\n");
+          break;
+        }
+        // Prebuilt reply goes out as is if answer wasn't changed
+        if (!(tp->xmit_ready && ser_spec_hit(tp->ser, tp->spec_ver))) {
+          msg_pack(tp);
+        }
+        msg_send(tp);
+#if (S2M_DUP_WINDOW_MS)
+        dup_save(tp);
+#endif
+        msg_spec(tp);
+      }
+      // Response message from slave, session is told about it in its
+      // own thread
+      else {
+        tp->recv_sta = RECV_IDLE;
+        if (msg_unpack(tp) == 0) ev_post(tp->ev, EV_RESP, 0);
+      }
+    } break;
+
+    case EV_SENT: {
+      // Request is due (timer or user), it's sent by session when the
+      // previous one is done
+      if (tp->mode == MODE_POLL) tp->req = true;
+    } break;
+
+    case EV_RESP: {
+      // Reply was accepted, by receive thread in split mode
+      tp->rsp = true;
+    } break;
+
+    case EV_EXEC: {
+      // Command for next requests, applied between frames
+      ser_set_cmd(tp->ser, msg->arg);
+      // Prebuilt request carries previous command, it's built again for
+      // the same page
+      if (tp->xmit_ready && (tp->mode == MODE_POLL)) {
+        ser_out_drop(tp->ser);
+        tp->xmit_ready = false;
+      }
+#if (S2M_DUP_WINDOW_MS)
+      // Cached reply may carry previous command
+      tp->dup_size = 0;
+#endif
+    } break;
+
+    case EV_ADDR: {
+      // Prebuilt request or reply carries previous address
+      tp->id = msg->arg;
+      if (tp->xmit_ready) {
+        ser_out_drop(tp->ser);
+        tp->xmit_ready = false;
+      }
+#if (S2M_DUP_WINDOW_MS)
+      // Retry of request to old address must not get cached reply
+      tp->dup_size = 0;
+#endif
+    } break;
+
+    default: break;
+  }
+}
+
+/**
+ * Handle all queued events in order they were posted.
+ *
+ * @param tp pointer to object
+ * @param ev event queue
+ * @param wait time to block for the first event, ms
+ */
+static void dispatch(transp_t *tp, ev_t ev, u32_t wait)
+{
+  ev_msg_t msg;
+  while (ev_get(ev, &msg, wait)) {
+    handle(tp, &msg);
+    wait = 0;
+  }
+}
+
+/**
+ * Drop partly received frame if line was silent for too long.
+ * Otherwise the tail of broken frame would be glued to the next one.
+ *
+ * @param tp pointer to object
+ */
+static void expire(transp_t *tp)
+{
+  if (gap_left(tp) == 0) {
+    tp->recv_sta = RECV_IDLE;
+  }
+}
+
+/**
+ * Request/reply session of POLL mode.
+ * Sends request when it's due, waits for reply and repeats unanswered
+ * request. Requests due while waiting are merged into one.
+ *
+ * @param tp pointer to object
+ * @return coroutine state (PT_WAITING, PT_ENDED...)
+ */
+static PT_THREAD(session(transp_t *tp))
+{
+  if (tp->mode != MODE_POLL) return PT_ENDED;
+
+  PT_BEGIN(&tp->pt);
+  for (;;) {
+    PT_WAIT_UNTIL(&tp->pt, tp->req);
+    tp->req = false;
+    tp->rsp = false;
+    tp->retry = 0;
+
+    if (!tp->xmit_ready) msg_pack(tp);
+    msg_send(tp);
+    for (;;) {
+      // In split mode line is handed over to receive thread, which is
+      // woken to wait for reply
+      if (tp->split) ev_wake(tp->ev_rx);
+      // Request is still on the line when write returns, and reply takes
+      // its own time, so both are added at line rate
+      tp->rsp_end = tmr_now_us() + (u64_t)S2M_RSP_TIMEOUT_MS * 1000 +
+                    (u64_t)(GET_XMIT(tp->ser)->size + IN_MSG_SIZE_POLL) *
+                    rs485_get_char_us(tp->stty);
+      tp->rsp_wait = true;
+#if (S2M_XMIT_PREBUILD)
+      // Next request is built while this one waits for reply, so only
+      // buffers are swapped when it's due
+      if (!tp->xmit_ready) {
+        msg_pack(tp);
+        tp->xmit_ready = true;
+      }
+#endif
+      PT_WAIT_UNTIL(&tp->pt, tp->rsp || (left_ms(tp->rsp_end) == 0));
+      tp->rsp_wait = false;
+      if (tp->rsp || (tp->retry == S2M_RSP_RETRIES)) break;
+      // Request is still in transmit buffer
+      tp->retry++;
+      msg_xmit(tp);
+    }
+    if (!tp->rsp) tp->rsp_lost++;
+  }
+  PT_END(&tp->pt);
+}
+
+/**
+ * Time left to deadline.
+ *
+ * @param end deadline, us
+ * @return time rounded up so the deadline has passed when caller wakes
+ *         up, ms (0 - passed)
+ */
+static s32_t left_ms(u64_t end)
+{
+  u64_t now = tmr_now_us();
+  return (now >= end) ? 0 : (s32_t)((end - now + 999) / 1000);
+}
+
+/**
+ * Time left to end of frame gap.
+ *
+ * @param tp pointer to transport object
+ * @return time, ms (0 - passed, -1 - no frame is being received)
+ */
+static s32_t gap_left(transp_t *tp)
+{
+  return (tp->recv_sta == RECV_ACT) ? left_ms(tp->rx_us + tp->gap_us) : -1;
+}
+
 // Parse incoming, build outgoing messages
 
 /**
@@ -237,11 +613,29 @@ void transp_set_id(transp_t *self, u32_t id)
  * Checks address, CRC checksum and calls upper layer parsing.
  */
 static s32_t msg_unpack(transp_t *self)
+{
+  if (msg_check(self) < 0) return -1;
+
+  // Call upper layer
+  s32_t rc = ser_in_parse(self->ser);
+  if (rc < 0) {
+    printf("[msg_unpack] failed to parse message\n");
+    return -1;
+  }
+
+  return 0;
+}
+
+/**
+ * Validate received message.
+ * Checks size, address and CRC checksum.
+ */
+static s32_t msg_check(transp_t *self)
 {
   buf_rcvd_t pbuf = GET_RCVD(self->ser);
 
   if (pbuf->size < 3) {
-    printf("[msg_unpack] size < 3\n");
+    printf("[msg_check] size < 3\n");
     return -1;
   }
 
@@ -249,7 +643,7 @@ static s32_t msg_unpack(transp_t *self)
 
   // Address check
   if (pbuf->buf[pbuf->pos++] != 12) {
-    printf("[msg_unpack] invalid address\n");
+    printf("[msg_check] invalid address\n");
     return -1;
   }
 
@@ -263,14 +657,7 @@ static s32_t msg_unpack(transp_t *self)
   #error "Please define any CRC type"
 #endif
   {
-    printf("[msg_unpack] invalid CRC\n");
-    return -1;
-  }
-
-  // Call upper layer
-  s32_t rc = ser_in_parse(self->ser);
-  if (rc < 0) {
-    printf("[msg_unpack] failed to parse message\n");
+    printf("[msg_check] invalid CRC\n");
     return -1;
   }
 
@@ -280,10 +667,11 @@ static s32_t msg_unpack(transp_t *self)
 /**
  * Pack message for transmission with CRC.
  * Builds message with address, calls upper layer and adds CRC.
+ * Message is built into the spare buffer, 'msg_send' swaps them.
  */
 static void msg_pack(transp_t *self)
 {
-  buf_xmit_t pbuf = GET_XMIT(self->ser);
+  buf_xmit_t pbuf = GET_NEXT(self->ser);
 
   pbuf->pos = 0;
   pbuf->size = 0;
@@ -295,6 +683,36 @@ static void msg_pack(transp_t *self)
   ser_out_build(self->ser);
 
   // Calculate and add CRC
+  msg_crc(pbuf);
+}
+
+/**
+ * Prebuild reply in SLAVE mode.
+ * Kept in the spare buffer and rebuilt when answer changes, so on request
+ * only buffers are swapped.
+ */
+static void msg_spec(transp_t *self)
+{
+#if (S2M_XMIT_PREBUILD)
+  if (self->mode != MODE_SLAVE) return;
+  if (self->xmit_ready && ser_spec_valid(self->ser, self->spec_ver)) return;
+
+  buf_xmit_t pbuf = GET_NEXT(self->ser);
+  pbuf->pos = 0;
+  pbuf->size = 0;
+  pbuf->buf[pbuf->size++] = self->id;
+  self->xmit_ready = ser_out_spec(self->ser, &self->spec_ver);
+  if (self->xmit_ready) msg_crc(pbuf);
+#else
+  (void)self;
+#endif
+}
+
+/**
+ * Add CRC to packed message.
+ */
+static void msg_crc(buf_xmit_t pbuf)
+{
   u16_t crc = crc16(pbuf->buf, pbuf->size);
 #if (CRC_YURA)&&(!CRC_MODBUS)
   u8_t *ptr = pbuf->buf + pbuf->size;
@@ -308,6 +726,64 @@ static void msg_pack(transp_t *self)
 #endif
 }
 
+/**
+ * Start transmission of packed message.
+ */
+static void msg_send(transp_t *self)
+{
+  ser_flip_xmit(self->ser);
+  self->xmit_ready = false;
+  msg_xmit(self);
+}
+
+/**
+ * Transmit message from transmit buffer from its beginning.
+ */
+static void msg_xmit(transp_t *self)
+{
+  GET_XMIT(self->ser)->pos = 0;
+  self->xmit_sta = XMIT_ACT;
+  rs485_ena(self->stty, false, true);
+  rs485_poll_tx(self->stty);
+}
+
+#if (S2M_DUP_WINDOW_MS)
+/**
+ * Check if received request repeats the last accepted one.
+ * CRC is compared first, whole frame only on its match.
+ *
+ * @param self pointer to object
+ * @return true if it's a retry within S2M_DUP_WINDOW_MS
+ */
+static bool dup_find(transp_t *self)
+{
+  buf_rcvd_t pbuf = GET_RCVD(self->ser);
+
+  if (!self->dup_size || (pbuf->size != self->dup_size)) return false;
+  if (B_TO_S(pbuf->buf[pbuf->size-2], pbuf->buf[pbuf->size-1]) !=
+      self->dup_crc) return false;
+  if (tmr_now_us() - self->dup_us > (u64_t)S2M_DUP_WINDOW_MS * 1000) {
+    return false;
+  }
+  return memcmp(pbuf->buf, self->dup_buf, pbuf->size) == 0;
+}
+
+/**
+ * Remember accepted request, its reply stays in transmit buffer.
+ *
+ * @param self pointer to object
+ */
+static void dup_save(transp_t *self)
+{
+  buf_rcvd_t pbuf = GET_RCVD(self->ser);
+
+  memcpy(self->dup_buf, pbuf->buf, pbuf->size);
+  self->dup_size = pbuf->size;
+  self->dup_crc = B_TO_S(pbuf->buf[pbuf->size-2], pbuf->buf[pbuf->size-1]);
+  self->dup_us = tmr_now_us();
+}
+#endif
+
 // Functor implementation for receive/transmit via rs485 module
 
 /**
@@ -327,9 +803,16 @@ static void recv_impl(void *opaque, u32_t len)
     case RECV_IDLE:
       self->recv_sta = RECV_ACT;
       pbuf->size = 0;
+      // Waiting thread starts counting frame gap
+      if (self->rx_irq) {
+        self->rx_us = tmr_now_us();
+        ev_wake(self->ev_rx);
+      }
       __FALLTHROUGH; // No break - continue processing in RECV_ACT
 
     case RECV_ACT: {
+      self->rx_us = tmr_now_us();
+      pbuf->ts = self->rx_us;
       for (u32_t i=0; i<len; i++) {
         if (rs485_get(self->stty, &byte)) {
           if (pbuf->size < BUFSIZE) {
@@ -338,8 +821,11 @@ static void recv_impl(void *opaque, u32_t len)
         }
       }
 
-      if (pbuf->size >= IN_MSG_SIZE_SLAVE) {
-        ev_post(self->ev_rcvd, EV_RCVD);
+      // Reply of slave is shorter than request of master
+      u32_t full = (self->mode == MODE_POLL) ? IN_MSG_SIZE_POLL :
+                                               IN_MSG_SIZE_SLAVE;
+      if (pbuf->size >= full) {
+        ev_post(self->ev_rx, EV_RCVD, 0);
       }
     } break;
   }
@@ -0,0 +1,28 @@
+/**
+  * @file   port_poller.h
+  * @author Ilia Proniashin, msg@proglyk.ru
+  * @date   18-October-2026
+  */
+
+#ifndef PORT_POLLER_H
+#define PORT_POLLER_H
+
+#include "port_conf.h"
+#include "port_types.h"
+#include <stdbool.h>
+
+#define POLLER_USE_STATIC               (0) //PORT_USE_STATIC
+
+// Wait without timeout
+#define POLLER_FOREVER                  (-1)
+
+typedef struct poller_s *poller_t;
+
+poller_t poller_new(void);
+void  poller_del(poller_t);
+bool  poller_add(poller_t, fd_t, u32_t);            // Descriptor and its key
+bool  poller_rem(poller_t, fd_t);
+s32_t poller_wait(poller_t, u32_t *, u32_t, s32_t); // Keys of ready ones,
+                                                    // timeout, ms
+
+#endif //PORT_POLLER_H
@@ -16,6 +16,8 @@
 
 #define RS485_USE_STATIC                (0) // PORT_USE_STATIC
 
+#define RS485_BAUD_DEFAULT              (230400)
+
 typedef struct {
   void (*func_rcv)(void *, u32_t);
   void (*func_xmt)(void *);
@@ -24,14 +26,28 @@ typedef struct {
 
 typedef struct rs485_s *rs485_t;
 
+// Статистика приема (кем был пойман кадр) и удержания линии передатчиком
+typedef struct {
+  u32_t spin_hits;    // Bytes caught while spinning
+  u32_t spin_miss;    // Spin window expired without bytes
+  u32_t block_hits;   // Bytes caught while blocked
+  u32_t de_frames;    // Frames sent with nRE/DE control
+  u32_t de_hold_us;   // nRE/DE hold time of the last frame, us
+  u32_t de_hold_max;  // Longest nRE/DE hold time, us
+} rs485_stats_t;
+
 // linux, win32
 rs485_t rs485_new(void *, rs485_fn_t *);
 void    rs485_del(rs485_t);
 void    rs485_ena(rs485_t, bool, bool);
 void    rs485_poll_tx(rs485_t);
-void    rs485_poll_rx(rs485_t);
+void    rs485_poll_rx(rs485_t, u32_t);
 bool    rs485_get(rs485_t, u8_t *);
 bool    rs485_put(rs485_t, u8_t);
 void    rs485_ena_wait(rs485_t self, bool wait_tx);
+bool    rs485_set_wake(rs485_t, fd_t);
+fd_t    rs485_get_fd(rs485_t);
+void    rs485_get_stats(rs485_t, rs485_stats_t *);
+u32_t   rs485_get_char_us(rs485_t);
 
 #endif //PORT_RS485_H
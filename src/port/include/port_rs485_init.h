@@ -34,6 +34,15 @@ typedef struct {
   const char *device_path;      // "/dev/ttyS4"
   const char *gpio_path;        // "/sys/class/gpio/gpio60"
   u32_t gpio_pin;
+  u32_t spin_us;                // Busy-poll after receive window opens, us
+                                // (0 - always block)
+  u32_t baud;                   // Line rate, any supported by UART
+                                // (0 - RS485_BAUD_DEFAULT)
+  char  parity;                 // 'N', 'E' or 'O' (0 - 'N')
+  u8_t  stop_bits;              // 1 or 2 (0 - 1)
+#endif
+#if (PORT_IMPL==PORT_IMPL_RTOS)&&(RTOS_HW_IMPL==RTOS_HW_IMPL_SIM)
+  u32_t uart;                   // Virtual UART index (0..VUART_NUM-1)
 #endif
   fn_t tx_callback;
   fn_t rx_callback;
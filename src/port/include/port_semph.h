@@ -0,0 +1,27 @@
+/**
+  * @file   port_semph.h
+  * @author Ilia Proniashin, msg@proglyk.ru
+  * @date   18-October-2026
+  */
+
+#ifndef PORT_SEMPH_H
+#define PORT_SEMPH_H
+
+#include "port_conf.h"
+#include "port_types.h"
+#include <stdbool.h>
+
+#define SEMPH_USE_STATIC                (0) //PORT_USE_STATIC
+
+// Wait without timeout
+#define SEMPH_FOREVER                   (0xffffffffU)
+
+typedef struct semph_s *semph_t;
+
+semph_t semph_new(void);
+void  semph_del(semph_t);
+void  semph_post(semph_t);          // Safe from other threads and ISR
+bool  semph_wait(semph_t, u32_t);   // Timeout, ms (0 - don't block)
+fd_t  semph_get_fd(semph_t);        // Pollable descriptor or -1
+
+#endif //PORT_SEMPH_H
@@ -9,13 +9,25 @@
 
 #include "port_conf.h"
 #include "port_types.h"
+#include <stdbool.h>
 
 #define THREAD_USE_STATIC               (0) //PORT_USE_STATIC
 
 typedef struct thread_s *thread_t;
 //typedef struct thread_s *thread_inst_t;
 
-thread_t thread_new(const u8_t *, void *(*)(void *), void *);
+// Атрибуты потока, нулевые поля - значения по умолчанию
+typedef struct {
+  u32_t prio;       // Real-time priority 1..99 (0 - default scheduling)
+  bool  rr;         // Round-robin among equal priorities (false - FIFO)
+  u32_t cpus;       // CPU affinity mask (0 - any CPU)
+  u32_t stack;      // Stack size, bytes
+  u32_t prefault;   // Stack bytes touched on start (0 - off), below stack size
+} thread_attr_t;
+
+thread_t thread_new(const u8_t *, void *(*)(void *), void *,
+                    const thread_attr_t *);
+s32_t thread_lock_mem( void );
 void  thread_del(thread_t);
 s32_t thread_kill(thread_t, s32_t);
 void  thread_exit( void );
@@ -25,6 +25,7 @@ s32_t tmr__ena(tmr_t);
 void  tmr__dis(tmr_t);
 
 // shared
+u64_t tmr_now_us(void);
 
 
 // stm32 only
@@ -40,12 +40,16 @@ typedef s32_t     fd_t;
 #define __PACKED      __attribute__((__packed__))
 #define __WEAK        __attribute__((weak))
 #define __FALLTHROUGH __attribute__((fallthrough))
+#define __THREAD      __thread
+#define __ALIGNED(n)  __attribute__((aligned(n)))
 
 #elif defined (__ICCARM__)
 
 #define __UNUSED
 #define __PACKED
 #define __WEAK   __weak
+#define __THREAD
+#define __ALIGNED(n)
 
 #endif
 
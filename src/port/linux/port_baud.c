@@ -0,0 +1,42 @@
+/**
+  * @file   port_baud.c
+  * @author Ilia Proniashin, msg@proglyk.ru
+  * @date   14-November-2025
+  */
+
+#ifndef __unix__
+#error "Should only be compiled under a unix system"
+#endif
+
+#include "port_baud.h"
+#include <asm/termbits.h>
+#include <stdio.h>
+#include <sys/ioctl.h>
+
+// ============================= Публичные функции =============================
+
+/**
+  * @brief  Set arbitrary line rate
+  * @param  fd - descriptor of opened port
+  * @param  baud - rate, baud
+  * @return 0 on success, -1 on error
+  */
+s32_t baud_set(fd_t fd, u32_t baud)
+{
+  struct termios2 tio;
+  
+  if (ioctl(fd, TCGETS2, &tio) < 0) {
+    perror("[baud_set] TCGETS2");
+    return -1;
+  }
+  // Скорость задается числом, одинаковая на прием и передачу
+  tio.c_cflag &= ~(CBAUD | (CBAUD << IBSHIFT));
+  tio.c_cflag |= BOTHER | (BOTHER << IBSHIFT);
+  tio.c_ispeed = baud;
+  tio.c_ospeed = baud;
+  if (ioctl(fd, TCSETS2, &tio) < 0) {
+    perror("[baud_set] TCSETS2");
+    return -1;
+  }
+  return 0;
+}
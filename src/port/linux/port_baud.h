@@ -0,0 +1,16 @@
+/**
+  * @file   port_baud.h
+  * @author Ilia Proniashin, msg@proglyk.ru
+  * @date   14-November-2025
+  */
+
+#ifndef PORT_BAUD_H
+#define PORT_BAUD_H
+
+#include "port_types.h"
+
+// Установка произвольной скорости через termios2/BOTHER. Вынесена в
+// отдельный модуль: <asm/termbits.h> несовместим с <termios.h>
+s32_t baud_set(fd_t, u32_t);
+
+#endif //PORT_BAUD_H
@@ -0,0 +1,85 @@
+/**
+  * @file   port_poller.c
+  * @author Ilia Proniashin, msg@proglyk.ru
+  * @date   18-October-2026
+  */
+
+#include "port_poller.h"
+#include "port_alloc.h"
+#include <assert.h>
+#include <errno.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
+// Число событий, забираемых за один вызов ядра
+#define POLLER_BATCH                    (64)
+
+// Ожидание множества дескрипторов через epoll: стоимость ожидания не зависит
+// от их числа, поэтому один поток может обслуживать тысячи линий
+struct poller_s {
+  fd_t fd;
+  struct epoll_event ev[POLLER_BATCH];
+};
+
+PORT_STATIC_DECLARE(POLLER, struct poller_s);
+
+// ============================= Публичные функции =============================
+
+/**
+  * @brief Create poller
+  */
+poller_t poller_new(void)
+{
+  PORT_ALLOC(POLLER, struct poller_s, self, return NULL);
+
+  self->fd = epoll_create1(EPOLL_CLOEXEC);
+  if (self->fd < 0) {
+    PORT_FREE(POLLER, self);
+    return NULL;
+  }
+  return self;
+}
+
+/**
+  * @brief Delete poller
+  */
+void poller_del(poller_t self)
+{
+  assert(self);
+  close(self->fd);
+  PORT_FREE(POLLER, self);
+}
+
+/**
+  * @brief Add descriptor, its key is returned when it's ready for reading
+  */
+bool poller_add(poller_t self, fd_t fd, u32_t key)
+{
+  assert(self);
+  struct epoll_event ev = { .events = EPOLLIN, .data.u32 = key };
+  return epoll_ctl(self->fd, EPOLL_CTL_ADD, fd, &ev) == 0;
+}
+
+/**
+  * @brief Remove descriptor
+  */
+bool poller_rem(poller_t self, fd_t fd)
+{
+  assert(self);
+  return epoll_ctl(self->fd, EPOLL_CTL_DEL, fd, NULL) == 0;
+}
+
+/**
+  * @brief Wait for descriptors
+  * @return number of keys placed, 0 on timeout, -1 on error
+  */
+s32_t poller_wait(poller_t self, u32_t *keys, u32_t max, s32_t timeout)
+{
+  assert(self && keys);
+  if (max > POLLER_BATCH) max = POLLER_BATCH;
+
+  int n = epoll_wait(self->fd, self->ev, (int)max, timeout);
+  if (n < 0) return (errno == EINTR) ? 0 : -1;
+  for (int i=0; i<n; i++) keys[i] = self->ev[i].data.u32;
+  return n;
+}
@@ -12,12 +12,15 @@
 #include "port_rs485_init.h"
 #include "port_alloc.h"
 #include "port_thread.h"
+#include "port_tmr.h"
+#include "port_baud.h"
 #if (PORT_IMPL==PORT_IMPL_LINUX)&&(LINUX_HW_IMPL==LINUX_HW_IMPL_ARM)
 #include "gpio.h"
 #endif
 #include <assert.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <stdatomic.h>
 #include <linux/serial.h>
 #include <termios.h>
 #include <stdio.h>
@@ -39,32 +42,45 @@ typedef enum { DIR_IN=0, DIR_OUT } dir_t;
 
 struct rs485_s {
   fd_t  fd;
+  fd_t  wake_fd;
   //char  dev_name[16];
   struct termios tio_old;
+  void  *fn_pld;
+  u32_t spin_us;
+#if (PORT_IMPL==PORT_IMPL_LINUX)&&(LINUX_HW_IMPL==LINUX_HW_IMPL_ARM)
+  gpio_t *nre_de;
+#endif
+
+  // Прием и передача могут идти в разных потоках, поэтому их поля разнесены
+  // по строкам кэша; общие только флаг разрешения приема и его поколение
+  atomic_bool sta_ena_rx __ALIGNED(PORT_CACHE_LINE);
+  atomic_uint rx_gen;
   
-  bool  sta_ena_rx;
-  u8_t  rcvd_buf[RCVD_BUF_SIZE];
+  u8_t  rcvd_buf[RCVD_BUF_SIZE] __ALIGNED(PORT_CACHE_LINE);
   u32_t rcvd_pos;
   void (*fn_rcv)(void *, u32_t);
-  void  *fn_pld;
+  u32_t rx_gen_seen;
+  u64_t spin_end;
+  rs485_stats_t stats;
   
-  bool  sta_ena_tx;
+  bool  sta_ena_tx __ALIGNED(PORT_CACHE_LINE);
   bool  sta_send_tx;
   bool  sta_wait_tx;
   u8_t  xmit_buf[XMIT_BUF_SIZE];
   u32_t xmit_size;
   fn_t  fn_xmt;
-
-#if (PORT_IMPL==PORT_IMPL_LINUX)&&(LINUX_HW_IMPL==LINUX_HW_IMPL_ARM)
-  gpio_t *nre_de;
-#endif
+  u32_t char_us;
+  u32_t de_frames;
+  u32_t de_hold_us;
+  u32_t de_hold_max;
 };
 
-static bool  receive(fd_t, u8_t *, u32_t, u32_t *);
+static bool  receive(fd_t, fd_t, u32_t, u8_t *, u32_t, u32_t *);
 static bool  transmit(fd_t, const u8_t *, u32_t);
 #if (PORT_IMPL==PORT_IMPL_LINUX)&&(LINUX_HW_IMPL==LINUX_HW_IMPL_ARM)
 static s32_t nre_de_init(rs485_t, const char *, u32_t);
 static s32_t nre_de_set(rs485_t, dir_t);
+static void  nre_de_release(rs485_t, u64_t);
 static void  nre_de_del(rs485_t);
 #endif
 
@@ -90,12 +106,23 @@ rs485_t rs485_new(void *init, rs485_fn_t *fn)
   self->fn_rcv = fn->func_rcv;
   self->fn_xmt = fn->func_xmt;
   self->fn_pld = fn->pld;
+  self->wake_fd = -1;
+  self->spin_us = pinit->spin_us;
   
   // check the name
   if (!pinit->device_path) {
     printf("[rs485_new] Dev name must be valid\n");
     goto exit_0;
   }
+  // check the line format
+  u32_t baud = pinit->baud ? pinit->baud : RS485_BAUD_DEFAULT;
+  char  parity = pinit->parity ? pinit->parity : 'N';
+  u32_t stop_bits = pinit->stop_bits ? pinit->stop_bits : 1;
+  if ((parity != 'N' && parity != 'E' && parity != 'O') ||
+      (stop_bits != 1 && stop_bits != 2)) {
+    printf("[rs485_new] Invalid line format\n");
+    goto exit_0;
+  }
   // try open
   self->fd = open( pinit->device_path, O_RDWR | O_NOCTTY | O_NONBLOCK);
   if (self->fd < 0) {
@@ -120,15 +147,19 @@ rs485_t rs485_new(void *init, rs485_fn_t *fn)
   tio.c_iflag &= ~(IGNBRK | BRKINT | PARMRK | ISTRIP | INLCR | IGNCR | ICRNL | IXON);
   tio.c_oflag &= ~OPOST;
   tio.c_lflag &= ~(ECHO | ECHONL | ICANON | ISIG | IEXTEN);
-  tio.c_cflag &= ~(CSIZE | PARENB);
+  tio.c_cflag &= ~(CSIZE | PARENB | PARODD | CSTOPB);
   // Устанавливаем нужные параметры
   tio.c_iflag |= IGNBRK | INPCK;
   tio.c_cflag |= CREAD | CLOCAL | CS8;
-  cfsetispeed(&tio, B230400);
-  cfsetospeed(&tio, B230400);
+  if (parity != 'N') tio.c_cflag |= PARENB;
+  if (parity == 'O') tio.c_cflag |= PARODD;
+  if (stop_bits == 2) tio.c_cflag |= CSTOPB;
   // Таймауты для неблокирующего чтения
   tio.c_cc[VMIN] = 0;
   tio.c_cc[VTIME] = 0;
+  // Время символа: старт, 8 бит данных, четность и стоп-биты, мкс
+  u32_t bits = 1 + 8 + (parity != 'N') + stop_bits;
+  self->char_us = (bits * 1000000 + baud - 1) / baud;
 
   // Применяем настройки
   tcflush(self->fd, TCIFLUSH);
@@ -136,6 +167,11 @@ rs485_t rs485_new(void *init, rs485_fn_t *fn)
     perror("Error setting attributes");
     goto exit_1;
   }
+  // Скорость ставится отдельно, чтобы была доступна любая, а не только Bxxx
+  if (baud_set(self->fd, baud) < 0) {
+    printf("[rs485_new] Can't set %u baud\n", baud);
+    goto exit_1;
+  }
 
 #if (PORT_IMPL==PORT_IMPL_LINUX)&&(LINUX_HW_IMPL==LINUX_HW_IMPL_ARM)
   if (pinit->gpio_path) {
@@ -185,11 +221,12 @@ void rs485_ena(rs485_t self, bool ena_rx, bool ena_tx)
 {
   assert(ena_rx ^ ena_tx);
   
-  self->sta_ena_rx = ena_rx;
   if (ena_rx) {
     tcflush( self->fd, TCIFLUSH );
-    self->rcvd_pos = 0;
+    // Новое поколение открывает окно ожидания ответа/следующего кадра
+    atomic_fetch_add_explicit(&self->rx_gen, 1, memory_order_relaxed);
   }
+  atomic_store_explicit(&self->sta_ena_rx, ena_rx, memory_order_release);
   
   
   if (ena_tx) {
@@ -211,6 +248,55 @@ void rs485_ena_wait(rs485_t self, __UNUSED bool wait_tx)
   self->sta_wait_tx = true;
 }
 
+/**
+  * @brief  Set descriptor which interrupts waiting for line in rs485_poll_rx()
+  * @param  self - ?
+  * @param  fd - Pollable descriptor (-1 - don't wait for line)
+  * @return true if waiting is supported
+  */
+bool rs485_set_wake(rs485_t self, fd_t fd)
+{
+  assert(self);
+  self->wake_fd = fd;
+  return true;
+}
+
+/**
+  * @brief  Get descriptor of port for external event loop
+  * @param  self - ?
+  * @return Descriptor, readable when bytes are received
+  */
+fd_t rs485_get_fd(rs485_t self)
+{
+  assert(self);
+  return self->fd;
+}
+
+/**
+  * @brief  Get receive statistics
+  * @param  self - ?
+  * @param  stats - Place for statistics
+  */
+void rs485_get_stats(rs485_t self, rs485_stats_t *stats)
+{
+  assert(self && stats);
+  *stats = self->stats;
+  stats->de_frames = self->de_frames;
+  stats->de_hold_us = self->de_hold_us;
+  stats->de_hold_max = self->de_hold_max;
+}
+
+/**
+  * @brief  Character time at configured line format
+  * @param  self - ?
+  * @return time, us
+  */
+u32_t rs485_get_char_us(rs485_t self)
+{
+  assert(self);
+  return self->char_us;
+}
+
 /**
   * @brief  ?
   * @param  self - ?
@@ -241,23 +327,51 @@ bool rs485_put(rs485_t self, u8_t byte)
 }
 
 /**
-  * @brief  ?
+  * @brief  Read received bytes
   * @param  self - ?
+  * @param  wait_us - Max time to wait for line or wake descriptor, us
+  *                   (0 - don't block)
   */
-void rs485_poll_rx(rs485_t self)
+void rs485_poll_rx(rs485_t self, u32_t wait_us)
 {
   u32_t rcvd = 0;
+  bool  ok = false;
   
-  if (self->sta_ena_rx) {
-    if ( !receive(self->fd, self->rcvd_buf, RCVD_BUF_SIZE, &rcvd) ) {
-      // printf("[rs485_poll_rx] Nothing to read\n");
-      return;
-    }
-    if (rcvd > 0) {
-      if (self->fn_rcv) self->fn_rcv(self->fn_pld, rcvd);
-      self->rcvd_pos = 0;
-    }
+  if (!atomic_load_explicit(&self->sta_ena_rx, memory_order_acquire)) {
+    // Приемник выключен: ждем только событие, линию не трогаем
+    if (wait_us) receive(-1, self->wake_fd, wait_us, NULL, 0, &rcvd);
+    return;
+  }
+  u32_t gen = atomic_load_explicit(&self->rx_gen, memory_order_relaxed);
+  if (gen != self->rx_gen_seen) {
+    self->rx_gen_seen = gen;
+    self->rcvd_pos = 0;
+    if (self->spin_us) self->spin_end = tmr_now_us() + self->spin_us;
   }
+
+  // В начале окна крутимся на неблокирующем read(), затем блокируемся.
+  // Окно одно на поколение: повторный взвод после каждой порции давал бы
+  // промах за каждым кадром и задерживал его обработку на spin_us
+  if (self->spin_end && wait_us) {
+    do {
+      ok = receive(self->fd, -1, 0, self->rcvd_buf, RCVD_BUF_SIZE, &rcvd) &&
+           (rcvd > 0);
+    } while (!ok && (tmr_now_us() < self->spin_end));
+    if (ok) self->stats.spin_hits++;
+    else self->stats.spin_miss++;
+    self->spin_end = 0;
+  }
+  if (!ok) {
+    ok = receive(self->fd, self->wake_fd, wait_us, self->rcvd_buf,
+                 RCVD_BUF_SIZE, &rcvd) && (rcvd > 0);
+    if (ok && wait_us) self->stats.block_hits++;
+  }
+  if (!ok) {
+    // printf("[rs485_poll_rx] Nothing to read\n");
+    return;
+  }
+  self->rcvd_pos = 0;
+  if (self->fn_rcv) self->fn_rcv(self->fn_pld, rcvd);
 }
 
 /**
@@ -273,14 +387,14 @@ void rs485_poll_rx(rs485_t self)
          if (self->fn_xmt) self->fn_xmt(self->fn_pld);
        }
  #if (PORT_IMPL==PORT_IMPL_LINUX)&&(LINUX_HW_IMPL==LINUX_HW_IMPL_ARM)
+       u64_t de_us = tmr_now_us();
        if (self->nre_de) nre_de_set(self, DIR_OUT);
  #endif
        if (!transmit(self->fd, self->xmit_buf, self->xmit_size)) {
          perror("Сan't send the frame completely");
        }
  #if (PORT_IMPL==PORT_IMPL_LINUX)&&(LINUX_HW_IMPL==LINUX_HW_IMPL_ARM)
-       thread_sleep(PORT_RS485_DE_WAIT);
-       if (self->nre_de) nre_de_set(self, DIR_IN);
+       if (self->nre_de) nre_de_release(self, de_us);
  #endif
      }
    }
@@ -293,22 +407,29 @@ void rs485_poll_rx(rs485_t self)
   * @param self - ?
   * @param to_recv - ?
   */
-static bool receive(fd_t fd, u8_t *buf, u32_t size, u32_t *rcvd)
+static bool receive(fd_t fd, fd_t wake, u32_t wait_us, u8_t *buf, u32_t size,
+                    u32_t *rcvd)
 {
   fd_set         rfds;
   struct timeval tv;
   ssize_t        rc;
   
-  tv.tv_sec = 0;
-  tv.tv_usec = 250; // 250 мкс
+  // Порт открыт с O_NONBLOCK, без ожидания сразу читаем
+  if (wait_us == 0) goto read;
+
+  tv.tv_sec = wait_us / 1000000;
+  tv.tv_usec = wait_us % 1000000;
   FD_ZERO( &rfds );
-  FD_SET( fd, &rfds );
+  if (fd >= 0) FD_SET( fd, &rfds );
+  // Спим до прихода данных или события (дескриптор события не вычитываем)
+  if (wake >= 0) FD_SET( wake, &rfds );
   
-  rc = select( fd + 1, &rfds, NULL, NULL, &tv );
+  rc = select( ((wake > fd) ? wake : fd) + 1, &rfds, NULL, NULL, &tv );
   if (rc < 0) return false;
   
-  if( !FD_ISSET(fd, &rfds) ) return false;
+  if( (fd < 0) || !FD_ISSET(fd, &rfds) ) return false;
   
+read:
   rc = read( fd, (void *)buf, (size_t)size );
   if (rc < 0) return false;
   *rcvd = ( u32_t ) rc;
@@ -395,4 +516,35 @@ static s32_t nre_de_set(rs485_t self, dir_t direction)
   return gpio_write(self->nre_de, (direction==DIR_IN) ? false : true);
 }
 
+/**
+  * @brief Release nRE/DE when the frame has actually left the line
+  * @param self - ?
+  * @param de_us - time nRE/DE was set, us
+  */
+static void nre_de_release(rs485_t self, u64_t de_us)
+{
+  int  lsr;
+  bool temt = false;
+  
+  // Ждем, пока драйвер отдаст все байты в UART
+  tcdrain(self->fd);
+  // Затем пока не опустеют FIFO и сдвиговый регистр (не дольше буфера)
+  u64_t end = tmr_now_us() + (u64_t)self->char_us * XMIT_BUF_SIZE;
+  while (ioctl(self->fd, TIOCSERGETLSR, &lsr) == 0) {
+    if (lsr & TIOCSER_TEMT) { temt = true; break; }
+    if (tmr_now_us() >= end) break;
+  }
+  // Регистр не читается: последний символ мог еще не уйти, ждем его время
+  if (!temt) {
+    end = tmr_now_us() + self->char_us;
+    while (tmr_now_us() < end);
+  }
+  nre_de_set(self, DIR_IN);
+  
+  u32_t hold = (u32_t)(tmr_now_us() - de_us);
+  self->de_hold_us = hold;
+  if (hold > self->de_hold_max) self->de_hold_max = hold;
+  self->de_frames++;
+}
+
 #endif
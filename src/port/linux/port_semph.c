@@ -0,0 +1,91 @@
+/**
+  * @file   port_semph.c
+  * @author Ilia Proniashin, msg@proglyk.ru
+  * @date   18-October-2026
+  */
+
+#include "port_semph.h"
+#include "port_alloc.h"
+#include <assert.h>
+#include <errno.h>
+#include <poll.h>
+#include <stdint.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+// Семафор построен на eventfd: его дескриптор можно добавить в select/poll
+// вместе с дескриптором порта, чтобы ожидание линии прерывалось событием
+struct semph_s {
+  fd_t fd;
+};
+
+PORT_STATIC_DECLARE(SEMPH, struct semph_s);
+
+// ============================= Публичные функции =============================
+
+/**
+  * @brief Create semaphore
+  */
+semph_t semph_new(void)
+{
+  PORT_ALLOC(SEMPH, struct semph_s, self, return NULL);
+
+  self->fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (self->fd < 0) {
+    PORT_FREE(SEMPH, self);
+    return NULL;
+  }
+  return self;
+}
+
+/**
+  * @brief Delete semaphore
+  */
+void semph_del(semph_t self)
+{
+  assert(self);
+  close(self->fd);
+  PORT_FREE(SEMPH, self);
+}
+
+/**
+  * @brief Signal semaphore
+  */
+void semph_post(semph_t self)
+{
+  uint64_t one = 1;
+  assert(self);
+  // Счетчик eventfd насыщается, повторные сигналы до ожидания сливаются
+  while ((write(self->fd, &one, sizeof(one)) < 0) && (errno == EINTR)) {}
+}
+
+/**
+  * @brief Wait for semaphore
+  * @param ms - Timeout, ms (SEMPH_FOREVER - without timeout)
+  * @return true if semaphore was signalled, false on timeout
+  */
+bool semph_wait(semph_t self, u32_t ms)
+{
+  uint64_t cnt;
+  struct pollfd pfd = { .fd = self->fd, .events = POLLIN };
+  assert(self);
+
+  if (ms) {
+    int rc;
+    do {
+      rc = poll(&pfd, 1, (ms == SEMPH_FOREVER) ? -1 : (int)ms);
+    } while ((rc < 0) && (errno == EINTR));
+    if (rc <= 0) return false;
+  }
+  // Сбрасываем счетчик
+  return read(self->fd, &cnt, sizeof(cnt)) == (ssize_t)sizeof(cnt);
+}
+
+/**
+  * @brief Get pollable descriptor
+  */
+fd_t semph_get_fd(semph_t self)
+{
+  assert(self);
+  return self->fd;
+}
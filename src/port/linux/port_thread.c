@@ -4,14 +4,21 @@
   * @date   28-September-2025
   */
 
+#define _GNU_SOURCE // pthread_setname_np, CPU_SET
+
 #include "port_thread.h"
 #include "port_alloc.h"
 #include <assert.h>
+#include <errno.h>
 #include <pthread.h>
+#include <sched.h>
 #include <signal.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <sys/mman.h>
 #include <time.h>
+#include <unistd.h>
 
 // Макрос PORT_USE_STATIC должен быть выкл. т.к. библиотека 'c-periphery' 
 // не поддерживает статичной аллокации
@@ -19,24 +26,56 @@
 #error "Macro 'PORT_USE_THREADS' must be enabled if you're using port_thread.c"
 #endif
 
+// Запас стека, который не трогается при prefault: кадры start() и функции
+// пользователя, TLS и guard-страница glibc
+#define THREAD_PREFAULT_GUARD           (64 * 1024)
+
 struct thread_s {
   pthread_t     tid;
   int           state;
+  void       *(*fn)(void *);
+  void         *pld;
+  u32_t         prefault;
+  char          name[16];
 };
 
+static void *start(void *);
+static void  prefault(u32_t);
+static s32_t set_attr(pthread_attr_t *, const thread_attr_t *);
+
 PORT_STATIC_DECLARE(THREAD, struct thread_s);
 
 // ============================= Публичные функции =============================
 
 /**
   * @brief Run function addressed by pointer 'fn' under a new thread
+  * @param name - Thread name (up to 15 symbols are seen by system)
+  * @param attr - Thread attributes (NULL - default)
   */
-thread_t thread_new( __UNUSED const u8_t *name, void *(*fn)(void *),
-                      void *pld )
+thread_t thread_new( const u8_t *name, void *(*fn)(void *), void *pld,
+                      const thread_attr_t *attr )
 {
+  pthread_attr_t pattr;
   PORT_ALLOC(THREAD, struct thread_s, self, return NULL);
+  self->fn = fn;
+  self->pld = pld;
+  self->prefault = attr ? attr->prefault : 0;
+  // Системе видны только 15 символов имени
+  if (name) strncpy(self->name, (const char *)name, sizeof(self->name) - 1);
 
-  int rc = pthread_create( &(self->tid), NULL, fn, pld );
+  if (pthread_attr_init(&pattr)) goto exit;
+  if (attr && set_attr(&pattr, attr)) {
+    pthread_attr_destroy(&pattr);
+    goto exit;
+  }
+  int rc = pthread_create( &(self->tid), &pattr, start, (void *)self );
+  if ((rc == EPERM) && attr && attr->prio) {
+    // Нет прав на SCHED_FIFO/RR (CAP_SYS_NICE), работаем с обычным приоритетом
+    printf("[thread_new] No permission for RT priority, using default\n");
+    pthread_attr_setinheritsched(&pattr, PTHREAD_INHERIT_SCHED);
+    rc = pthread_create( &(self->tid), &pattr, start, (void *)self );
+  }
+  pthread_attr_destroy(&pattr);
   if (rc) goto exit;
   self->state = 1;
   return self;
@@ -73,6 +112,18 @@ void thread_exit( void )
   return pthread_exit(NULL);
 }
 
+/**
+  * @brief Lock current and future pages of process in RAM
+  */
+s32_t thread_lock_mem( void )
+{
+  if (mlockall(MCL_CURRENT | MCL_FUTURE) < 0) {
+    perror("[thread_lock_mem] mlockall");
+    return -1;
+  }
+  return 0;
+}
+
 /**
   * @brief Sleep
   */
@@ -84,3 +135,71 @@ void thread_sleep(u32_t ms)
   tspec.tv_nsec = (ms % 1000)*1000000;
   nanosleep(&tspec, NULL);
 }
+
+// ============================ Статические функции ============================
+
+/**
+  * @brief Thread entry: set name, prefault stack, then run user function
+  */
+static void *start(void *arg)
+{
+  thread_t self = (thread_t)arg;
+  if (self->name[0]) pthread_setname_np(pthread_self(), self->name);
+  if (self->prefault) prefault(self->prefault);
+  return self->fn(self->pld);
+}
+
+/**
+  * @brief Touch every page of stack region so it's mapped before work
+  */
+static __attribute__((noinline)) void prefault(u32_t size)
+{
+  u8_t buf[size];
+  volatile u8_t *ptr = buf; // запись не должна быть выброшена компилятором
+  long page = sysconf(_SC_PAGESIZE);
+  for (u32_t i=0; i<size; i+=(u32_t)page) ptr[i] = 0;
+}
+
+/**
+  * @brief Translate thread attributes to pthread ones
+  */
+static s32_t set_attr(pthread_attr_t *pattr, const thread_attr_t *attr)
+{
+  if (attr->stack && pthread_attr_setstacksize(pattr, attr->stack)) {
+    printf("[thread_new] Invalid stack size %u\n", attr->stack);
+    return -1;
+  }
+  if (attr->prefault) {
+    // Размер по умолчанию берется из RLIMIT_STACK (обычно 8 МиБ)
+    size_t stack = 0;
+    pthread_attr_getstacksize(pattr, &stack);
+    if ((stack <= THREAD_PREFAULT_GUARD) ||
+        (attr->prefault > stack - THREAD_PREFAULT_GUARD)) {
+      printf("[thread_new] Prefault size %u exceeds stack %zu minus %u\n",
+             attr->prefault, stack, THREAD_PREFAULT_GUARD);
+      return -1;
+    }
+  }
+  if (attr->prio) {
+    struct sched_param prm = { .sched_priority = (int)attr->prio };
+    int policy = attr->rr ? SCHED_RR : SCHED_FIFO;
+    if (pthread_attr_setinheritsched(pattr, PTHREAD_EXPLICIT_SCHED) ||
+        pthread_attr_setschedpolicy(pattr, policy) ||
+        pthread_attr_setschedparam(pattr, &prm)) {
+      printf("[thread_new] Invalid priority %u\n", attr->prio);
+      return -1;
+    }
+  }
+  if (attr->cpus) {
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (u32_t i=0; i<32; i++) {
+      if (attr->cpus & (1U << i)) CPU_SET(i, &set);
+    }
+    if (pthread_attr_setaffinity_np(pattr, sizeof(set), &set)) {
+      printf("[thread_new] Invalid CPU mask 0x%x\n", attr->cpus);
+      return -1;
+    }
+  }
+  return 0;
+}
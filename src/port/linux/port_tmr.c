@@ -11,6 +11,7 @@
 #include "port_tmr.h"
 #include "port_alloc.h"
 #include <sys/time.h>
+#include <time.h>
 #include <assert.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -125,3 +126,14 @@ void tmr__dis(tmr_t self)
   assert(self);
   self->enabled = false;
 }
+
+/**
+  * @brief Monotonic time
+  * @retval Microseconds since unspecified point
+  */
+u64_t tmr_now_us(void)
+{
+  struct timespec tspec;
+  clock_gettime(CLOCK_MONOTONIC, &tspec);
+  return (u64_t)tspec.tv_sec * 1000000ULL + (u64_t)tspec.tv_nsec / 1000U;
+}
@@ -0,0 +1,69 @@
+/**
+ * @file port_poller.c
+ * @author Ilia Proniashin, msg@proglyk.ru
+ * @date 18-October-2026
+ */
+
+#include "port_poller.h"
+#include "port_alloc.h"
+#include "port_thread.h"
+#include <assert.h>
+
+// Descriptors don't exist here, lines are driven by interrupts: waiting only
+// paces caller, which processes every line on each pass
+struct poller_s {
+  u32_t num;
+};
+
+PORT_STATIC_DECLARE(POLLER, struct poller_s);
+
+/**
+ * @brief Create poller
+ * @return Pointer to poller_t object or NULL on error
+ */
+poller_t poller_new(void)
+{
+  PORT_ALLOC(POLLER, struct poller_s, self, return NULL);
+  return self;
+}
+
+/**
+ * @brief Delete poller
+ * @param self - Pointer to poller_t object
+ */
+void poller_del(poller_t self)
+{
+  assert(self);
+  PORT_FREE(POLLER, self);
+}
+
+/**
+ * @brief Add descriptor (not supported)
+ * @return false
+ */
+bool poller_add(poller_t self, fd_t fd, u32_t key)
+{
+  (void)self; (void)fd; (void)key;
+  return false;
+}
+
+/**
+ * @brief Remove descriptor (not supported)
+ * @return false
+ */
+bool poller_rem(poller_t self, fd_t fd)
+{
+  (void)self; (void)fd;
+  return false;
+}
+
+/**
+ * @brief Wait for timeout (1 ms if it's not set)
+ * @return 0
+ */
+s32_t poller_wait(poller_t self, u32_t *keys, u32_t max, s32_t timeout)
+{
+  (void)self; (void)keys; (void)max;
+  if (timeout != 0) thread_sleep((timeout > 0) ? (u32_t)timeout : 1);
+  return 0;
+}
@@ -160,6 +160,52 @@ void rs485_ena(rs485_inst_t self, bool ena_rx, bool ena_tx)
   }
 }
 
+/**
+  * @brief Set descriptor interrupting wait for line (no descriptors in RTOS)
+  * @param self - Pointer to rs485_inst_t object
+  * @param fd - Pollable descriptor
+  * @return false, caller must block on its events instead
+  */
+bool rs485_set_wake(rs485_inst_t self, fd_t fd)
+{
+  (void)self;
+  (void)fd;
+  return false;
+}
+
+/**
+  * @brief Get descriptor of port (no descriptors in RTOS)
+  * @param self - Pointer to rs485_inst_t object
+  * @return -1
+  */
+fd_t rs485_get_fd(rs485_inst_t self)
+{
+  (void)self;
+  return -1;
+}
+
+/**
+  * @brief Character time at configured line format (8 data, 2 stop bits)
+  * @param self - Pointer to rs485_inst_t object
+  * @return time, us
+  */
+u32_t rs485_get_char_us(rs485_inst_t self)
+{
+  u32_t baud = self->huart.Init.BaudRate;
+  return baud ? (11 * 1000000 + baud - 1) / baud : 0;
+}
+
+/**
+  * @brief Get receive statistics (receive is interrupt driven, nothing to count)
+  * @param self - Pointer to rs485_inst_t object
+  * @param stats - Place for statistics
+  */
+void rs485_get_stats(rs485_inst_t self, rs485_stats_t *stats)
+{
+  (void)self;
+  memset(stats, 0, sizeof(*stats));
+}
+
 /**
   * @brief Get byte from receive buffer
   * @param self - Pointer to rs485_inst_t object
@@ -0,0 +1,91 @@
+/**
+ * @file port_semph.c
+ * @author Ilia Proniashin, msg@proglyk.ru
+ * @date 18-October-2026
+ */
+
+#include "port_semph.h"
+#include "port_alloc.h"
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "task.h"
+#include <assert.h>
+
+struct semph_s {
+  SemaphoreHandle_t sem;
+};
+
+PORT_STATIC_DECLARE(SEMPH, struct semph_s);
+
+/**
+ * @brief Create binary semaphore
+ * @return Pointer to semph_t object or NULL on error
+ */
+semph_t semph_new(void)
+{
+  PORT_ALLOC(SEMPH, struct semph_s, self, return NULL);
+
+  self->sem = xSemaphoreCreateBinary();
+  if (self->sem == NULL) {
+    PORT_FREE(SEMPH, self);
+    return NULL;
+  }
+  return self;
+}
+
+/**
+ * @brief Delete semaphore
+ * @param self - Pointer to semph_t object
+ */
+void semph_del(semph_t self)
+{
+  assert(self);
+  vSemaphoreDelete(self->sem);
+  PORT_FREE(SEMPH, self);
+}
+
+/**
+ * @brief Signal semaphore (from task or interrupt)
+ * @param self - Pointer to semph_t object
+ */
+void semph_post(semph_t self)
+{
+  assert(self);
+#if (RTOS_HW_IMPL==RTOS_HW_IMPL_SIM)
+  // В POSIX-порте нет xPortIsInsideInterrupt(), "прерывания" симулятора
+  // обслуживаются задачами
+  xSemaphoreGive(self->sem);
+#else
+  if (xPortIsInsideInterrupt()) {
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(self->sem, &woken);
+    portYIELD_FROM_ISR(woken);
+  } else {
+    xSemaphoreGive(self->sem);
+  }
+#endif
+}
+
+/**
+ * @brief Wait for semaphore
+ * @param self - Pointer to semph_t object
+ * @param ms - Timeout, ms (SEMPH_FOREVER - without timeout)
+ * @return true if semaphore was signalled, false on timeout
+ */
+bool semph_wait(semph_t self, u32_t ms)
+{
+  assert(self);
+  TickType_t ticks = (ms == SEMPH_FOREVER) ? portMAX_DELAY : pdMS_TO_TICKS(ms);
+  return xSemaphoreTake(self->sem, ticks) == pdTRUE;
+}
+
+/**
+ * @brief Get pollable descriptor (not available)
+ * @param self - Pointer to semph_t object
+ * @return -1
+ */
+fd_t semph_get_fd(semph_t self)
+{
+  (void)self;
+  return -1;
+}
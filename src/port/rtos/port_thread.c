@@ -12,6 +12,7 @@
 #include "port_alloc.h"
 #include "FreeRTOS.h"
 #include "task.h"
+#include "semphr.h"
 #include <assert.h>
 #include <string.h>
 #include <stdio.h>
@@ -21,11 +22,24 @@
 #error "Macro 'PORT_USE_THREADS' must be enabled if you're using port_thread.c"
 #endif
 
+// Индекс локального указателя задачи, хранящего ее объект thread_t
+#define THREAD_TLS_IDX                  (0)
+
+#if (configNUM_THREAD_LOCAL_STORAGE_POINTERS <= THREAD_TLS_IDX)
+#error "'configNUM_THREAD_LOCAL_STORAGE_POINTERS' must be at least 1"
+#endif
+
 struct thread_s {
   TaskHandle_t tid;
   int state;
+  void *(*fn)(void *);
+  void *pld;
+  SemaphoreHandle_t done;   // Выдается задачей перед самоудалением
 };
 
+static void start(void *);
+static UBaseType_t map_prio(u32_t);
+
 PORT_STATIC_DECLARE(THREAD, struct thread_s);
 
 /**
@@ -33,48 +47,71 @@ PORT_STATIC_DECLARE(THREAD, struct thread_s);
  * @param name - Thread name (used for debugging in FreeRTOS)
  * @param fn - Function pointer to execute in new thread
  * @param pld - Payload pointer passed to function
+ * @param attr - Thread attributes (NULL - default), 'rr' and 'prefault'
+ *               are ignored
  * @return Pointer to thread_t object or NULL on error
  */
-thread_t thread_new(const u8_t *name, void *(*fn)(void *), void *pld)
+thread_t thread_new(const u8_t *name, void *(*fn)(void *), void *pld,
+                    const thread_attr_t *attr)
 {
   PORT_ALLOC(THREAD, struct thread_s, self, return NULL);
+  self->fn = fn;
+  self->pld = pld;
+  self->done = xSemaphoreCreateBinary();
+  if (!self->done) goto exit;
   
-  // Создаем задачу FreeRTOS
-  // Используем приведение типа функции для совместимости
+  // Размер стека в словах, приоритет 1..99 растягиваем на приоритеты задач
+  configSTACK_DEPTH_TYPE depth = 4 * configMINIMAL_STACK_SIZE;
+  UBaseType_t prio = tskIDLE_PRIORITY + 1;
+  if (attr && attr->stack) depth = attr->stack / sizeof(StackType_t);
+  if (attr && attr->prio) prio = map_prio(attr->prio);
+  // Поле rr не используется: разделение времени между задачами равного
+  // приоритета задается для всех сразу (configUSE_TIME_SLICING), prefault
+  // тоже не нужен, стек задачи выделен из кучи целиком
+
+  // Создаем задачу FreeRTOS, функция пользователя вызывается из start()
   int rc = xTaskCreate(
-    (TaskFunction_t)fn,                     // Функция задачи
+    start,                                  // Функция задачи
     (const char *)(name ? name : "thread"), // Имя задачи
-    4 * configMINIMAL_STACK_SIZE,           // Размер стека
-    pld,                                    // Параметр задачи
-    tskIDLE_PRIORITY + 1,                   // Приоритет
+    depth,                                  // Размер стека
+    (void *)self,                           // Параметр задачи
+    prio,                                   // Приоритет
     &(self->tid)                            // Хэндл задачи
   );
   
   if (rc != pdPASS) goto exit;
+
+#if (configUSE_CORE_AFFINITY == 1) && (configNUMBER_OF_CORES > 1)
+  if (attr && attr->cpus) vTaskCoreAffinitySet(self->tid, attr->cpus);
+#endif
   
   self->state = 1;
   printf("[thread_new] Created thread '%s'\n", name ? name : "unnamed");
   return self;
 
 exit:
+  if (self->done) vSemaphoreDelete(self->done);
   PORT_FREE(THREAD, self);
   printf("[thread_new] Failed to create thread\n");
   return NULL;
 }
 
 /**
- * @brief Delete the running thread
+ * @brief Wait for thread to finish and free it (as pthread_join does).
+ *        Thread must be asked to stop before
  * @param self - Pointer to thread_t object
  */
 void thread_del(thread_t self)
 {
   assert(self);
   
-  // Удаляем задачу FreeRTOS
+  // Задача удаляет себя сама в thread_exit(), удаление отсюда могло бы
+  // прервать ее посреди работы или удалить ее второй раз
   if (self->tid != NULL) {
-    vTaskDelete(self->tid);
+    xSemaphoreTake(self->done, portMAX_DELAY);
     self->tid = NULL;
   }
+  vSemaphoreDelete(self->done);
   
   printf("[thread_del]\n");
   
@@ -106,6 +143,55 @@ s32_t thread_kill(thread_t self, s32_t sig)
  */
 void thread_exit(void)
 {
+  // Сообщаем ожидающему thread_del() и больше не трогаем объект, он может
+  // быть освобожден раньше, чем задача будет удалена
+  thread_t self = (thread_t)pvTaskGetThreadLocalStoragePointer(NULL,
+                                                               THREAD_TLS_IDX);
+  if (self) xSemaphoreGive(self->done);
   // В FreeRTOS удаляем текущую задачу
   vTaskDelete(NULL);
 }
+
+/**
+ * @brief Lock memory (nothing to do: no paging in FreeRTOS)
+ * @return 0
+ */
+s32_t thread_lock_mem(void)
+{
+  return 0;
+}
+
+/**
+ * @brief Sleep
+ * @param ms - Time to sleep, ms
+ */
+void thread_sleep(u32_t ms)
+{
+  if (ms < 1) ms = 1;
+  vTaskDelay(pdMS_TO_TICKS(ms));
+}
+
+/**
+ * @brief Task entry: remember object of task, then run user function
+ * @param arg - Pointer to thread_t object
+ */
+static void start(void *arg)
+{
+  thread_t self = (thread_t)arg;
+  vTaskSetThreadLocalStoragePointer(NULL, THREAD_TLS_IDX, (void *)self);
+  self->fn(self->pld);
+  // Задача FreeRTOS не может просто вернуться из функции
+  thread_exit();
+}
+
+/**
+ * @brief Map real-time priority 1..99 onto task priorities above idle
+ * @param prio - Priority 1..99
+ * @return Task priority 1..configMAX_PRIORITIES-1
+ */
+static UBaseType_t map_prio(u32_t prio)
+{
+  if (prio > 99) prio = 99;
+  return tskIDLE_PRIORITY + 1 +
+         (UBaseType_t)((prio - 1) * (configMAX_PRIORITIES - 2) / 98);
+}
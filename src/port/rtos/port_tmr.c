@@ -106,3 +106,13 @@ void tmr__dis(tmr_t self)
   assert(self);
   self->enabled = false;
 }
+
+/**
+ * @brief Monotonic time
+ * @retval Microseconds since scheduler start (tick resolution)
+ */
+u64_t tmr_now_us(void)
+{
+  // portTICK_PERIOD_MS равен 0 при частоте тиков выше 1 кГц, считаем от частоты
+  return (u64_t)xTaskGetTickCount() * 1000000U / configTICK_RATE_HZ;
+}
@@ -0,0 +1,265 @@
+/**
+ * @file port_rs485.c
+ * @author Ilia Proniashin, msg@proglyk.ru
+ * @date 18-October-2026
+ *
+ * RS485 of FreeRTOS POSIX simulator. Line is virtual UART (port_vuart.h),
+ * its receive interrupt is a task of the highest priority which hands every
+ * byte to the core as RXNE handler does. Port has no descriptor, so the core
+ * doesn't wait here: its receive handler wakes event queue by itself.
+ */
+
+#include "port_rs485.h"
+#include "port_rs485_init.h"
+#include "port_alloc.h"
+#include "port_vuart.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include <assert.h>
+#include <stdio.h>
+
+// Макрос RS485_USE_STATIC должен быть выкл., т.к. портов может быть несколько
+#if (RS485_USE_STATIC)
+#error "Macro 'RS485_USE_STATIC' must be disabled"
+#endif
+
+// Стек задачи "прерывания" приема, слов
+#define RS485_ISR_STACK                 (2 * configMINIMAL_STACK_SIZE)
+
+struct rs485_s {
+  u32_t uart;
+  void  *fn_pld;
+  TaskHandle_t isr;
+  u32_t char_us;
+
+  volatile bool sta_ena_rx;
+  u8_t  rcvd_buf[RCVD_BUF_SIZE];
+  u32_t rcvd_pos;
+  void (*fn_rcv)(void *, u32_t);
+  rs485_stats_t stats;
+
+  bool  sta_ena_tx;
+  bool  sta_send_tx;
+  bool  sta_wait_tx;
+  u8_t  xmit_buf[XMIT_BUF_SIZE];
+  u32_t xmit_size;
+  fn_t  fn_xmt;
+  u32_t de_frames;
+};
+
+static void isr_rx(void *);
+
+PORT_STATIC_DECLARE(RS485, struct rs485_s);
+
+// ============================= Публичные функции =============================
+
+/**
+  * @brief  Constructor of 'rs485_t' object
+  * @param  init - Pointer to 'rs485_init_t' (virtual port index and baud)
+  * @param  fn - Receive and transmit callbacks
+  * @return Pointer to object or NULL on error
+  */
+rs485_t rs485_new(void *init, rs485_fn_t *fn)
+{
+  rs485_init_t *pinit = (rs485_init_t *)init;
+  assert(pinit && fn);
+
+  PORT_ALLOC(RS485, struct rs485_s, self, return NULL);
+
+  self->fn_rcv = fn->func_rcv;
+  self->fn_xmt = fn->func_xmt;
+  self->fn_pld = fn->pld;
+  self->uart = pinit->uart;
+
+  if (!vuart_open(self->uart)) {
+    printf("[rs485_new] Can't open virtual UART %u\n", self->uart);
+    goto exit_0;
+  }
+  // Время символа 8N1, формат линии виртуальному порту не важен
+  u32_t baud = pinit->baud ? pinit->baud : RS485_BAUD_DEFAULT;
+  self->char_us = (10 * 1000000 + baud - 1) / baud;
+
+  // Прием выполняется на приоритете выше всех задач, как прерывание
+  if (xTaskCreate(isr_rx, "rs485-isr", RS485_ISR_STACK, self,
+                  configMAX_PRIORITIES - 1, &self->isr) != pdPASS) {
+    printf("[rs485_new] Can't create receive task\n");
+    goto exit_0;
+  }
+
+  return self;
+
+exit_0:
+  PORT_FREE(RS485, self);
+  return NULL;
+}
+
+/**
+  * @brief  Destructor
+  * @param  self - Pointer to object
+  */
+void rs485_del(rs485_t self)
+{
+  assert(self);
+
+  if (self->isr) vTaskDelete(self->isr);
+  PORT_FREE(RS485, self);
+}
+
+/**
+  * @brief  Switch direction of line
+  * @param  self - Pointer to object
+  * @param  ena_rx - Enable receiver
+  * @param  ena_tx - Enable transmitter
+  */
+void rs485_ena(rs485_t self, bool ena_rx, bool ena_tx)
+{
+  assert(ena_rx ^ ena_tx);
+
+  taskENTER_CRITICAL();
+  self->sta_ena_rx = ena_rx;
+  self->rcvd_pos = RCVD_BUF_SIZE;
+  taskEXIT_CRITICAL();
+
+  self->sta_ena_tx = ena_tx;
+  self->sta_send_tx = ena_tx;
+  self->sta_wait_tx = false;
+  if (ena_tx) self->xmit_size = 0;
+}
+
+void rs485_ena_wait(rs485_t self, __UNUSED bool wait_tx)
+{
+  assert(self);
+  self->sta_send_tx = false;
+  self->sta_wait_tx = true;
+}
+
+/**
+  * @brief  Wake descriptors are not supported, queue is woken by the core
+  * @param  self - Pointer to object
+  * @param  fd - Unused
+  * @return false
+  */
+bool rs485_set_wake(rs485_t self, __UNUSED fd_t fd)
+{
+  assert(self);
+  return false;
+}
+
+/**
+  * @brief  Virtual port has no descriptor
+  * @param  self - Pointer to object
+  * @return -1
+  */
+fd_t rs485_get_fd(rs485_t self)
+{
+  assert(self);
+  return -1;
+}
+
+/**
+  * @brief  Get receive statistics
+  * @param  self - Pointer to object
+  * @param  stats - Place for statistics
+  */
+void rs485_get_stats(rs485_t self, rs485_stats_t *stats)
+{
+  assert(self && stats);
+  *stats = self->stats;
+  stats->de_frames = self->de_frames;
+}
+
+/**
+  * @brief  Character time at configured baud
+  * @param  self - Pointer to object
+  * @return time, us
+  */
+u32_t rs485_get_char_us(rs485_t self)
+{
+  assert(self);
+  return self->char_us;
+}
+
+/**
+  * @brief  Get byte handed over by receive callback
+  * @param  self - Pointer to object
+  * @param  byte - Place for byte
+  * @return true if byte is taken
+  */
+bool rs485_get(rs485_t self, u8_t *byte)
+{
+  if (self->rcvd_pos < RCVD_BUF_SIZE) {
+    *byte = self->rcvd_buf[self->rcvd_pos++];
+    return true;
+  }
+  return false;
+}
+
+/**
+  * @brief  Put byte of frame being transmitted
+  * @param  self - Pointer to object
+  * @param  byte - Byte
+  * @return true if byte is taken
+  */
+bool rs485_put(rs485_t self, u8_t byte)
+{
+  assert(self);
+  if (self->xmit_size < XMIT_BUF_SIZE) {
+    self->xmit_buf[self->xmit_size++] = byte;
+    return true;
+  }
+  return false;
+}
+
+/**
+  * @brief  Nothing to read: bytes are handed to the core by receive task,
+  *         which wakes the core's event queue through receive callback
+  * @param  self - Pointer to object
+  * @param  wait_us - Unused, the core blocks on its event queue instead
+  */
+void rs485_poll_rx(rs485_t self, __UNUSED u32_t wait_us)
+{
+  assert(self);
+}
+
+/**
+  * @brief  Transmit frame: core puts bytes one by one as TXE handler does,
+  *         then frame goes to line at once
+  * @param  self - Pointer to object
+  */
+void rs485_poll_tx(rs485_t self)
+{
+  if (!self->sta_ena_tx) return;
+  if (!self->sta_send_tx || self->sta_wait_tx) return;
+
+  while (self->sta_send_tx) {
+    if (self->fn_xmt) self->fn_xmt(self->fn_pld);
+  }
+  if (vuart_dev_write(self->uart, self->xmit_buf, self->xmit_size) !=
+      self->xmit_size) {
+    printf("[rs485_poll_tx] Can't send the frame completely\n");
+  }
+  self->de_frames++;
+}
+
+// ============================ Статические функции ============================
+
+/**
+  * @brief  "Interrupt" of receiver: takes bytes from virtual UART one by one
+  * @param  pld - Pointer to object
+  */
+static void isr_rx(void *pld)
+{
+  rs485_t self = (rs485_t)pld;
+  u8_t byte;
+
+  for (;;) {
+    if (!vuart_dev_read(self->uart, &byte, 1, VUART_FOREVER)) continue;
+    // Выключенный приемник байты теряет, как и реальный
+    if (!self->sta_ena_rx) continue;
+
+    self->rcvd_buf[0] = byte;
+    self->rcvd_pos = 0;
+    self->stats.block_hits++;
+    if (self->fn_rcv) self->fn_rcv(self->fn_pld, 1);
+  }
+}
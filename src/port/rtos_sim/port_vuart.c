@@ -0,0 +1,93 @@
+/**
+ * @file port_vuart.c
+ * @author Ilia Proniashin, msg@proglyk.ru
+ * @date 18-October-2026
+ */
+
+#include "port_vuart.h"
+#include "FreeRTOS.h"
+#include "stream_buffer.h"
+#include "task.h"
+#include <assert.h>
+
+#define TICKS(ms) (((ms) == VUART_FOREVER) ? portMAX_DELAY : pdMS_TO_TICKS(ms))
+
+typedef struct {
+  StreamBufferHandle_t rx;  // Line -> device
+  StreamBufferHandle_t tx;  // Device -> line
+} vuart_t;
+
+static vuart_t vuart[VUART_NUM];
+
+/**
+ * @brief Create buffers of port (once)
+ * @param idx - Port index
+ * @return true if port is ready
+ */
+bool vuart_open(u32_t idx)
+{
+  if (idx >= VUART_NUM) return false;
+  
+  taskENTER_CRITICAL();
+  if (!vuart[idx].rx) {
+    // Receiver wakes on every byte, as UART interrupt does
+    vuart[idx].rx = xStreamBufferCreate(VUART_SIZE, 1);
+    vuart[idx].tx = xStreamBufferCreate(VUART_SIZE, 1);
+  }
+  taskEXIT_CRITICAL();
+  return vuart[idx].rx && vuart[idx].tx;
+}
+
+/**
+ * @brief Read bytes sent by peer
+ * @param idx - Port index
+ * @param buf - Buffer
+ * @param size - Buffer size
+ * @param ms - Time to wait for the first byte, ms (VUART_FOREVER - no limit)
+ * @return number of bytes read
+ */
+u32_t vuart_dev_read(u32_t idx, u8_t *buf, u32_t size, u32_t ms)
+{
+  assert(idx < VUART_NUM);
+  return xStreamBufferReceive(vuart[idx].rx, buf, size, TICKS(ms));
+}
+
+/**
+ * @brief Send bytes to peer
+ * @param idx - Port index
+ * @param buf - Data
+ * @param size - Data size
+ * @return number of bytes sent
+ */
+u32_t vuart_dev_write(u32_t idx, const u8_t *buf, u32_t size)
+{
+  assert(idx < VUART_NUM);
+  return xStreamBufferSend(vuart[idx].tx, buf, size, portMAX_DELAY);
+}
+
+/**
+ * @brief Read bytes sent by device
+ * @param idx - Port index
+ * @param buf - Buffer
+ * @param size - Buffer size
+ * @param ms - Time to wait for the first byte, ms (VUART_FOREVER - no limit)
+ * @return number of bytes read
+ */
+u32_t vuart_peer_read(u32_t idx, u8_t *buf, u32_t size, u32_t ms)
+{
+  if (!vuart_open(idx)) return 0;
+  return xStreamBufferReceive(vuart[idx].tx, buf, size, TICKS(ms));
+}
+
+/**
+ * @brief Send bytes to device
+ * @param idx - Port index
+ * @param buf - Data
+ * @param size - Data size
+ * @return number of bytes sent
+ */
+u32_t vuart_peer_write(u32_t idx, const u8_t *buf, u32_t size)
+{
+  if (!vuart_open(idx)) return 0;
+  return xStreamBufferSend(vuart[idx].rx, buf, size, portMAX_DELAY);
+}
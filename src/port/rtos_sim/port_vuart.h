@@ -0,0 +1,32 @@
+/**
+ * @file port_vuart.h
+ * @author Ilia Proniashin, msg@proglyk.ru
+ * @date 18-October-2026
+ *
+ * Virtual UART of FreeRTOS POSIX simulator: a pair of stream buffers per
+ * port, one for each direction. Device side is used by port_rs485.c,
+ * peer side by application standing for the other end of the line.
+ */
+
+#ifndef PORT_VUART_H
+#define PORT_VUART_H
+
+#include "port_types.h"
+#include <stdbool.h>
+
+// Number of virtual ports
+#define VUART_NUM                       (4)
+
+// Size of stream buffer of one direction, bytes
+#define VUART_SIZE                      (512)
+
+// Wait without timeout
+#define VUART_FOREVER                   (0xFFFFFFFFu)
+
+bool  vuart_open(u32_t);                            // Create port buffers
+u32_t vuart_dev_read(u32_t, u8_t *, u32_t, u32_t);  // Line -> device, ms
+u32_t vuart_dev_write(u32_t, const u8_t *, u32_t);  // Device -> line
+u32_t vuart_peer_read(u32_t, u8_t *, u32_t, u32_t); // Device -> peer, ms
+u32_t vuart_peer_write(u32_t, const u8_t *, u32_t); // Peer -> device
+
+#endif //PORT_VUART_H
@@ -9,9 +9,19 @@
 
 #if (S2M_USE_THREADS)
 #include "port_thread.h"
+#include "mms_if.h"
+#endif
+
+#if (S2M_USE_PUB)
+#include "pub.h"
+#endif
+
+#if (S2M_USE_STORE)
+#include "store.h"
 #endif
 
 #include <assert.h>
+#include <stdatomic.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdbool.h>
@@ -22,19 +32,37 @@
 struct ser2mms_s {
   transp_t *tp;  // Pointer to transport layer
   void *ied;  // Pointer to IED server
+  map_t map;  // Attribute mapping table
+  answ_t answ;  // Precomputed answer
 #if (S2M_USE_THREADS)
   thread_t thread;  // Worker thread descriptor
+#if (S2M_USE_SPLIT_RXTX)
+  thread_t thread_rx;  // Receive thread descriptor (POLL mode)
+#endif
+  atomic_bool stop;  // Stop request for worker thread
+#endif
+#if (S2M_USE_PUB)
+  pub_t pub;  // Publisher of received values
+#endif
+#if (S2M_USE_STORE)
+  store_t store;  // Latest-value store
 #endif
+#if (S2M_USE_GOOSE)
+  goose_t goose;  // GOOSE publisher
+#endif
+  s2m_loop_t *loop;  // Scheduler serving object (ser2mms_loop_add)
 };
 
 // Variable declarations
 STATIC_DECLARE(SER2MMS, struct ser2mms_s);
 
-// Global application running flag.
-extern int running;
-
 // Private function declarations
 static void *poll(void *);
+#if (S2M_USE_SPLIT_RXTX)
+static void *poll_rx(void *);
+#endif
+static void use_map(s2m_t *, map_t);
+static bool is_running(s2m_t *);
 
 // Public interface function definitions
 
@@ -43,7 +71,8 @@ static void *poll(void *);
 /**
 * Object constructor.
 */
-s2m_t *ser2mms_new(void *ied, u32_t mode, u32_t id, void *stty_init)
+s2m_t *ser2mms_new(void *ied, u32_t mode, u32_t id, void *stty_init,
+                   const s2m_ops_t *ops, void *ctx)
 {
   ALLOC(SER2MMS, struct ser2mms_s, self, return NULL);
   self->ied = ied;
@@ -54,6 +83,8 @@ s2m_t *ser2mms_new(void *ied, u32_t mode, u32_t id, void *stty_init)
   if (!self->tp) {
     goto error;
   }
+  // Bind callbacks, by default they get this object as context
+  ser_set_ops((ser_t)transp_get_top(self->tp), ops, ctx);
   return self;
 
 error:
@@ -67,28 +98,107 @@ error:
 void ser2mms_destroy(s2m_t *self)
 {
   assert(self);
-#if (S2M_USE_THREADS)
-  thread_del(self->thread);
+  ser2mms_stop(self);
+  if (self->loop) ser2mms_loop_del(self->loop, self);
+#if (S2M_USE_PUB)
+  if (self->pub) pub_destroy(self->pub);
+#endif
+#if (S2M_USE_STORE)
+  if (self->store) store_destroy(self->store);
+#endif
+#if (S2M_USE_GOOSE)
+  if (self->goose) goose_destroy(self->goose);
 #endif
   transp_destroy(0, (void *)self->tp);
+  if (self->map) map_destroy(self->map);
+  if (self->answ) answ_destroy(self->answ);
   FREE(SER2MMS, self);
 }
 
 /**
 * Start operation.
 */
-s32_t ser2mms_run(s2m_t *self)
+s32_t ser2mms_run(s2m_t *self, __UNUSED const s2m_opt_t *opt)
 {
   assert(self);
+#if (S2M_USE_PUB) || (S2M_USE_STORE)
+  ser_t top = (ser_t)transp_get_top(self->tp);
+#endif
+#if (S2M_USE_PUB)
+  bool new_pub = false;
+#endif
+#if (S2M_USE_STORE)
+  bool new_store = false;
+#endif
 #if (S2M_USE_THREADS)
-  self->thread = thread_new((const u8_t *)"srv", &poll, (void *)self->tp);
-  if (!self->thread) {
-    ser2mms_destroy(self);
-    return -1;
+  if (self->thread) return -1;
+  // Lock memory before threads are created so their stacks are locked too
+  if (opt && opt->lock_mem && (thread_lock_mem() < 0)) {
+    printf("[ser2mms_run] Can't lock memory\n");
+  }
+#endif
+#if (S2M_USE_PUB)
+  // Publisher thread must be ready before frames arrive
+  if (!self->pub) {
+    self->pub = pub_new(top);
+    if (!self->pub) goto error;
+    ser_set_pub(top, self->pub);
+    new_pub = true;
+  }
+#endif
+#if (S2M_USE_STORE)
+  // Store commits values by mapping table, without it values are applied
+  // in place by user functions
+  if (self->map && !self->store) {
+    self->store = store_new(self->map);
+    if (!self->store) goto error;
+    ser_set_store(top, self->store);
+    new_store = true;
+  } else if (!self->map) {
+    printf("[ser2mms_run] No mapping table, store is not used\n");
+  }
+#endif
+#if (S2M_USE_THREADS)
+  if (!(opt && opt->no_thread)) {
+    atomic_store(&self->stop, false);
+    self->thread = thread_new((const u8_t *)"s2m-srv", &poll, (void *)self,
+                              opt ? &opt->thread : NULL);
+    if (!self->thread) goto error;
+#if (S2M_USE_SPLIT_RXTX)
+    // Receiver gets its own thread with the same attributes, so reply
+    // parsing doesn't wait for request building and vice versa
+    if (transp_is_split(self->tp)) {
+      self->thread_rx = thread_new((const u8_t *)"s2m-rx", &poll_rx,
+                                   (void *)self, opt ? &opt->thread : NULL);
+      if (!self->thread_rx) goto error;   // Main thread is stopped there
+    }
+#endif
   }
 #endif
   transp_run(self->tp);
   return 0;
+
+#if (S2M_USE_THREADS) || (S2M_USE_PUB) || (S2M_USE_STORE)
+error:
+  // Undo only what was created by this call, object may be run again
+  printf("[ser2mms_run] Can't start\n");
+  ser2mms_stop(self);
+#if (S2M_USE_STORE)
+  if (new_store) {
+    ser_set_store(top, NULL);
+    store_destroy(self->store);
+    self->store = NULL;
+  }
+#endif
+#if (S2M_USE_PUB)
+  if (new_pub) {
+    ser_set_pub(top, NULL);
+    pub_destroy(self->pub);
+    self->pub = NULL;
+  }
+#endif
+  return -1;
+#endif
 }
 
 /**
@@ -98,10 +208,202 @@ void ser2mms_poll(s2m_t *self)
 {
   assert(self);
 #if (!S2M_USE_THREADS)
-  poll((void *)self->tp);
+  poll((void *)self);
 #endif
 }
 
+/**
+* Get descriptors for external event loop.
+*/
+u32_t ser2mms_get_fds(s2m_t *self, fd_t *fds, u32_t max)
+{
+  assert(self && fds);
+  return transp_get_fds(self->tp, fds, max);
+}
+
+/**
+* Get time to next deadline.
+*/
+s32_t ser2mms_get_timeout(s2m_t *self)
+{
+  assert(self);
+  return transp_get_timeout(self->tp);
+}
+
+/**
+* Process without blocking.
+*/
+s32_t ser2mms_process(s2m_t *self, u32_t ready)
+{
+  assert(self);
+#if (S2M_USE_THREADS)
+  if (self->thread) return -1;
+#endif
+  transp_process(self->tp, (ready & S2M_EV_RX) != 0);
+  return 0;
+}
+
+/**
+* Scheduler constructor.
+*/
+s2m_loop_t *ser2mms_loop_new(void)
+{
+  return loop_new();
+}
+
+/**
+* Scheduler destructor.
+*/
+void ser2mms_loop_destroy(s2m_loop_t *loop)
+{
+  loop_destroy(loop);
+}
+
+/**
+* Add instance to scheduler.
+*/
+s32_t ser2mms_loop_add(s2m_loop_t *loop, s2m_t *self)
+{
+  assert(loop && self);
+#if (S2M_USE_THREADS)
+  if (self->thread) return -1;
+#endif
+  if (self->loop) return -1;
+  if (loop_add(loop, self->tp) < 0) return -1;
+  self->loop = loop;
+  return 0;
+}
+
+/**
+* Remove instance from scheduler.
+*/
+s32_t ser2mms_loop_del(s2m_loop_t *loop, s2m_t *self)
+{
+  assert(loop && self);
+  if (self->loop != loop) return -1;
+  if (loop_remove(loop, self->tp) < 0) return -1;
+  self->loop = NULL;
+  return 0;
+}
+
+/**
+* Run one pass of scheduler.
+*/
+s32_t ser2mms_loop_run(s2m_loop_t *loop, s32_t wait_ms)
+{
+  return loop_run(loop, wait_ms);
+}
+
+/**
+* Stop operation.
+*/
+void ser2mms_stop(s2m_t *self)
+{
+  assert(self);
+#if (S2M_USE_THREADS)
+  if (!self->thread) return;
+  atomic_store(&self->stop, true);
+  transp_wake(self->tp);
+  thread_del(self->thread);
+  self->thread = NULL;
+#if (S2M_USE_SPLIT_RXTX)
+  if (self->thread_rx) {
+    thread_del(self->thread_rx);
+    self->thread_rx = NULL;
+  }
+#endif
+#endif
+}
+
+/**
+* Load attribute mapping table.
+*/
+s32_t ser2mms_load_map(s2m_t *self, const char *path)
+{
+  assert(self && path);
+  // Serial thread applies values by the table without locking
+  if (is_running(self)) return -1;
+  map_t map = map_new(self->ied, path);
+  if (!map) return -1;
+  use_map(self, map);
+  return 0;
+}
+
+/**
+* Set static attribute mapping table.
+*/
+s32_t ser2mms_set_map(s2m_t *self, const map_ent_t *tbl)
+{
+  assert(self && tbl);
+  if (is_running(self)) return -1;
+  map_t map = map_new_static(self->ied, tbl);
+  if (!map) return -1;
+  use_map(self, map);
+  return 0;
+}
+
+/**
+* Set answer attributes.
+*/
+s32_t ser2mms_set_answer(s2m_t *self, DataAttribute *const *attrs, u32_t num)
+{
+  assert(self && attrs);
+  // Serial thread reads the answer without locking
+  if (is_running(self)) return -1;
+  ser_t top = (ser_t)transp_get_top(self->tp);
+  // Old handlers go first, new ones may be installed on the same attributes
+  if (self->answ) {
+    ser_set_answ(top, NULL);
+    answ_destroy(self->answ);
+    self->answ = NULL;
+  }
+  self->answ = answ_new(self->ied, attrs, num);
+  if (!self->answ) return -1;
+  ser_set_answ(top, self->answ);
+  return 0;
+}
+
+/**
+* Set answer value changed locally.
+*/
+s32_t ser2mms_set_answer_value(s2m_t *self, u32_t idx, s16_t value)
+{
+  assert(self);
+  if (!self->answ || (idx >= answ_get_num(self->answ))) return -1;
+  answ_set(self->answ, idx, value);
+  return 0;
+}
+
+#if (S2M_USE_GOOSE)
+/**
+* Enable GOOSE fast path.
+*/
+s32_t ser2mms_set_goose(s2m_t *self, const goose_cfg_t *cfg)
+{
+  assert(self && cfg);
+  // Serial thread may be inside goose_publish() of the old publisher
+  if (is_running(self)) return -1;
+  goose_t goose = goose_new(cfg);
+  if (!goose) return -1;
+  ser_t top = (ser_t)transp_get_top(self->tp);
+  ser_set_goose(top, goose);
+  if (self->goose) goose_destroy(self->goose);
+  self->goose = goose;
+  return 0;
+}
+
+/**
+* Get GOOSE fast path statistics.
+*/
+s32_t ser2mms_get_goose_stats(s2m_t *self, goose_stats_t *stats)
+{
+  assert(self && stats);
+  if (!self->goose) return -1;
+  goose_get_stats(self->goose, stats);
+  return 0;
+}
+#endif
+
 // Functions with external implementation
 
 /** For SLAVE mode. */
@@ -124,6 +426,14 @@ void __WEAK ser2mms_read_subs(const sub_prm_t *buf, void *opaque)
   (void)buf; (void)opaque;
 }
 
+#if (S2M_USE_FRAME_VIEW)
+/** Read received frame. */
+void __WEAK ser2mms_read_frame(const frame_view_t *frm, void *opaque)
+{
+  (void)frm; (void)opaque;
+}
+#endif
+
 /** Write answer. */
 void __WEAK ser2mms_write_answer(answ_prm_t *buf, u32_t *buf_len)
 {
@@ -161,8 +471,7 @@ void *ser2mms_get_ied(s2m_t *self)
 void ser2mms_set_cmd(s2m_t *self, u32_t cmd)
 {
   assert(self);
-  ser_t top = (ser_t)transp_get_top(self->tp);
-  ser_set_cmd(top, cmd);
+  transp_exec(self->tp, cmd);
 }
 
 /**
@@ -174,6 +483,42 @@ void ser2mms_set_id(s2m_t *self, u32_t id)
   transp_set_id(self->tp, id);
 }
 
+/**
+* Getter for number of lost events.
+*/
+u32_t ser2mms_get_ev_lost(s2m_t *self)
+{
+  assert(self);
+  return transp_get_ev_lost(self->tp);
+}
+
+/**
+* Getter for number of unanswered requests.
+*/
+u32_t ser2mms_get_rsp_lost(s2m_t *self)
+{
+  assert(self);
+  return transp_get_rsp_lost(self->tp);
+}
+
+/**
+* Getter for number of answered retries.
+*/
+u32_t ser2mms_get_dup_hits(s2m_t *self)
+{
+  assert(self);
+  return transp_get_dup_hits(self->tp);
+}
+
+/**
+* Getter for receive statistics.
+*/
+void ser2mms_get_rx_stats(s2m_t *self, rs485_stats_t *stats)
+{
+  assert(self && stats);
+  transp_get_rx_stats(self->tp, stats);
+}
+
 /**
 * Test tick for debugging.
 */
@@ -188,21 +533,90 @@ void ser2mms_test_tick(s2m_t *self)
 /**
 * Thread function for periodic polling.
 *
-* @param opaque opaque pointer to transport layer object
+* @param opaque opaque pointer to ser2mms object
 */
 static void *poll(void *opaque)
 {
-  transp_t *tp = (transp_t *)opaque;
-  assert(tp);
+  s2m_t *self = (s2m_t *)opaque;
+  assert(self);
 
 #if (S2M_USE_THREADS)
+  // In split mode receiver runs in its own thread
+  bool split = transp_is_split(self->tp);
   do {
-    transp_poll(tp);
-  } while (running);
-  printf("[poll] Caught condition '!running', exiting...\n");
+    if (split) transp_poll_tx(self->tp);
+    else transp_poll(self->tp);
+  } while (!atomic_load(&self->stop));
+  printf("[poll] Caught stop request, exiting...\n");
+  mms_if_release();
   thread_exit();  // Terminate thread
 #else
-  transp_poll(tp);
+  transp_poll(self->tp);
 #endif
   return NULL;
 }
+
+#if (S2M_USE_SPLIT_RXTX)
+/**
+* Thread function for receive part in split mode.
+*
+* @param opaque opaque pointer to ser2mms object
+*/
+static void *poll_rx(void *opaque)
+{
+  s2m_t *self = (s2m_t *)opaque;
+  assert(self);
+
+  do {
+    transp_poll_rx(self->tp);
+  } while (!atomic_load(&self->stop));
+  printf("[poll_rx] Caught stop request, exiting...\n");
+  mms_if_release();
+  thread_exit();  // Terminate thread
+  return NULL;
+}
+#endif
+
+/**
+* Replace mapping table of object.
+* Publisher and store of previous run still use old table from their own
+* threads, so they are released here and created again by ser2mms_run.
+*
+* @param self pointer to object, not running
+* @param map new mapping object
+*/
+static void use_map(s2m_t *self, map_t map)
+{
+  ser_t top = (ser_t)transp_get_top(self->tp);
+#if (S2M_USE_PUB)
+  if (self->pub) {
+    ser_set_pub(top, NULL);
+    pub_destroy(self->pub);
+    self->pub = NULL;
+  }
+#endif
+#if (S2M_USE_STORE)
+  if (self->store) {
+    ser_set_store(top, NULL);
+    store_destroy(self->store);
+    self->store = NULL;
+  }
+#endif
+  ser_set_map(top, map);
+  if (self->map) map_destroy(self->map);
+  self->map = map;
+}
+
+/**
+* Check if object is served by its own thread or by scheduler.
+*
+* @param self pointer to object
+* @return true if serial thread may use the object
+*/
+static bool is_running(s2m_t *self)
+{
+#if (S2M_USE_THREADS)
+  if (self->thread) return true;
+#endif
+  return self->loop != NULL;
+}
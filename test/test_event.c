@@ -0,0 +1,229 @@
+/**
+ * @file test_event.c
+ * @author Ilia Proniashin, msg@proglyk.ru
+ * @date 19-October-2026
+ *
+ * Host-side test of event queue: overflow and lost counter, wraparound of
+ * ring positions, ordering with several producers.
+ */
+
+#include "event.h"
+#include "port_thread.h"
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdbool.h>
+
+/** Number of producer threads. */
+#define NUM_PROD (4)
+
+/** Events posted by each producer. */
+#define NUM_EVENTS (20000U)
+
+/** Number of laps over the ring in wraparound test. */
+#define NUM_LAPS (100000U)
+
+/** Consumer wait for the next event, ms. */
+#define GET_TIMEOUT_MS (1000)
+
+/** Check condition, report and count failure. */
+#define CHECK(cond) \
+  do { \
+    if (!(cond)) { \
+      printf("[%s] Line %d: check '%s' failed\n", __func__, __LINE__, #cond); \
+      fails++; \
+    } \
+  } while(0)
+
+/**
+ * Producer state.
+ */
+typedef struct {
+  ev_t ev;          // Queue
+  u32_t id;         // Producer number, upper byte of payload
+  u32_t full;       // Posts rejected because queue was full
+} prod_t;
+
+// Variable declarations
+
+static u32_t fails = 0;
+#if (EV_USE_THREADS)
+static atomic_bool go;      // Producers may start
+static atomic_bool stop;    // Producers give up, consumer failed
+#endif
+
+// Private function declarations
+
+static void test_full(void);
+static void test_wrap(void);
+#if (EV_USE_THREADS)
+static void test_mpsc(void);
+static void *produce(void *);
+#endif
+
+// Public interface function definitions
+
+int main(void)
+{
+  test_full();
+  test_wrap();
+#if (EV_USE_THREADS)
+  test_mpsc();
+#endif
+  printf("[test_event] %s (%u failed checks)\n",
+         fails ? "FAILED" : "PASSED", fails);
+  return fails ? 1 : 0;
+}
+
+// Private function definitions
+
+/**
+ * Full queue rejects post and counts it as lost, freed cell is reused.
+ */
+static void test_full(void)
+{
+  ev_msg_t msg;
+  ev_t ev = ev_new();
+  CHECK(ev);
+  if (!ev) return;
+
+  CHECK(!ev_get(ev, &msg, 0));
+  for (u32_t i=0; i<EV_QUEUE_DEPTH; i++) {
+    CHECK(ev_post(ev, EV_EXEC, i));
+  }
+  CHECK(ev_get_lost(ev) == 0);
+
+  // No room left
+  CHECK(!ev_post(ev, EV_EXEC, 100));
+  CHECK(!ev_post(ev, EV_ADDR, 101));
+  CHECK(ev_get_lost(ev) == 2);
+
+  // One taken, one more fits, rejected ones never show up
+  CHECK(ev_get(ev, &msg, 0) && (msg.type == EV_EXEC) && (msg.arg == 0));
+  CHECK(ev_post(ev, EV_ADDR, EV_QUEUE_DEPTH));
+  CHECK(!ev_post(ev, EV_ADDR, 102));
+  CHECK(ev_get_lost(ev) == 3);
+
+  for (u32_t i=1; i<EV_QUEUE_DEPTH; i++) {
+    CHECK(ev_get(ev, &msg, 0) && (msg.type == EV_EXEC) && (msg.arg == i));
+  }
+  CHECK(ev_get(ev, &msg, 0) && (msg.type == EV_ADDR) &&
+        (msg.arg == EV_QUEUE_DEPTH));
+  CHECK(!ev_get(ev, &msg, 0));
+  ev_destroy(ev);
+}
+
+/**
+ * Many laps over the ring with different fill levels keep FIFO order.
+ */
+static void test_wrap(void)
+{
+  ev_msg_t msg;
+  u32_t next_post = 0, next_get = 0;
+  ev_t ev = ev_new();
+  CHECK(ev);
+  if (!ev) return;
+
+  for (u32_t lap=0; lap<NUM_LAPS; lap++) {
+    // Fill level changes every lap, so positions drift over all cells
+    u32_t n = 1 + lap % EV_QUEUE_DEPTH;
+    for (u32_t i=0; i<n; i++) {
+      if (!ev_post(ev, EV_RCVD, next_post++)) fails++;
+    }
+    for (u32_t i=0; i<n; i++) {
+      if (!ev_get(ev, &msg, 0) || (msg.arg != next_get++)) fails++;
+    }
+  }
+  CHECK(!ev_get(ev, &msg, 0));
+  CHECK(ev_get_lost(ev) == 0);
+  CHECK(next_get == next_post);
+  ev_destroy(ev);
+}
+
+#if (EV_USE_THREADS)
+/**
+ * Several producers against one consumer: nothing is duplicated, events of
+ * each producer come in the order they were posted, rejected posts match
+ * lost counter.
+ */
+static void test_mpsc(void)
+{
+  prod_t prod[NUM_PROD];
+  thread_t thr[NUM_PROD];
+  u32_t next[NUM_PROD] = {0};
+  u32_t num = 0, total = 0, full = 0;
+  ev_msg_t msg;
+  ev_t ev = ev_new();
+  CHECK(ev);
+  if (!ev) return;
+
+  atomic_store(&go, false);
+  atomic_store(&stop, false);
+  for (; num<NUM_PROD; num++) {
+    prod[num].ev = ev;
+    prod[num].id = num;
+    prod[num].full = 0;
+    thr[num] = thread_new((const u8_t *)"ev-prod", &produce,
+                          (void *)&prod[num], NULL);
+    if (!thr[num]) {
+      printf("[test_mpsc] Can't start producer\n");
+      fails++;
+      atomic_store(&stop, true);
+      break;
+    }
+  }
+  atomic_store(&go, true);
+
+  while (!atomic_load(&stop) && (total < NUM_PROD * NUM_EVENTS)) {
+    if (!ev_get(ev, &msg, GET_TIMEOUT_MS)) {
+      printf("[test_mpsc] Timeout after %u events\n", total);
+      fails++;
+      atomic_store(&stop, true);
+      break;
+    }
+    u32_t id = msg.arg >> 24;
+    u32_t seq = msg.arg & 0xffffffU;
+    if ((msg.type != EV_RCVD) || (id >= NUM_PROD) || (seq != next[id])) {
+      printf("[test_mpsc] Unexpected event %u:%u\n", id, seq);
+      fails++;
+      atomic_store(&stop, true);
+      break;
+    }
+    next[id]++;
+    total++;
+  }
+
+  for (u32_t i=0; i<num; i++) {
+    thread_del(thr[i]);
+    full += prod[i].full;
+  }
+  if (!atomic_load(&stop)) {
+    CHECK(!ev_get(ev, &msg, 0));
+    CHECK(ev_get_lost(ev) == full);
+  }
+  printf("[test_mpsc] %u events, %u posts to full queue\n", total, full);
+  ev_destroy(ev);
+}
+
+/**
+ * Producer thread: posts numbered events, repeats rejected ones.
+ *
+ * @param opaque pointer to producer state
+ */
+static void *produce(void *opaque)
+{
+  prod_t *self = (prod_t *)opaque;
+
+  while (!atomic_load(&go)) {}
+  for (u32_t seq=0; seq<NUM_EVENTS; seq++) {
+    while (!ev_post(self->ev, EV_RCVD, (self->id << 24) | seq)) {
+      if (atomic_load(&stop)) goto exit;
+      self->full++;
+      thread_sleep(0);   // Let consumer drain the queue
+    }
+  }
+
+exit:
+  thread_exit();
+  return NULL;
+}
+#endif
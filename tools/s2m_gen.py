@@ -0,0 +1,274 @@
+#!/usr/bin/env python3
+"""
+@file s2m_gen.py
+@author Ilia Proniashin, msg@proglyk.ru
+@date 18-October-2026
+
+Static mapping table generator.
+Reads IED description (ICD/CID/SCL) and point list, emits C source with
+const fully resolved 'map_ent_t' table and typed update functions, linked
+against IEDMODEL_* symbols of libiec61850 static model.
+
+Point list format (one point per line, '#' starts comment):
+  P <ds> <page> <idx> <LDinst/LN.DO> [scale] [offset] [filter]
+  S <idx> <LDinst/LN.DO> [scale] [offset] [filter]
+Value type (s32 or f32) is taken from 'mag' attribute in ICD. Optional
+filter is any of "db=<abs>", "dbp=<percent>", "min=<ms>".
+
+Usage:
+  s2m_gen.py --icd model.icd --points points.txt --out gen/s2m_map_gen
+"""
+
+import argparse
+import os
+import sys
+import xml.etree.ElementTree as ET
+
+# 'ser' module settings (see src/core/include/ser.h)
+SER_MIN_DS_IDX = 1
+SER_MAX_DS_IDX = 6
+SER_MAX_PAGE_IDX = 3
+SER_PAGE_SIZE = 3
+SER_NUM_SUBS = 11
+
+# SCL basic types of 'mag' sub-attribute
+MAG_TYPES = {
+    'FLOAT32': ('f32', 'f'),
+    'INT32': ('s32', 'i'),
+}
+
+
+class GenError(Exception):
+    """Generator error with file position."""
+
+
+def strip_ns(root):
+    """Remove XML namespaces, SCL files use default one."""
+    for el in root.iter():
+        if '}' in el.tag:
+            el.tag = el.tag.split('}', 1)[1]
+
+
+def ln_name(ln):
+    """Full logical node name: prefix + lnClass + inst."""
+    return ln.get('prefix', '') + ln.get('lnClass', '') + ln.get('inst', '')
+
+
+class Model:
+    """IED model loaded from SCL file."""
+
+    def __init__(self, path, ied_name=None):
+        root = ET.parse(path).getroot()
+        strip_ns(root)
+        ieds = root.findall('IED')
+        if ied_name:
+            ieds = [i for i in ieds if i.get('name') == ied_name]
+        if not ieds:
+            raise GenError('%s: IED not found' % path)
+        self.ied = ieds[0]
+        tpl = root.find('DataTypeTemplates')
+        if tpl is None:
+            raise GenError('%s: DataTypeTemplates not found' % path)
+        self.ln_types = {t.get('id'): t for t in tpl.findall('LNodeType')}
+        self.do_types = {t.get('id'): t for t in tpl.findall('DOType')}
+        self.da_types = {t.get('id'): t for t in tpl.findall('DAType')}
+
+    def find_ln(self, ld_inst, name):
+        for ld in self.ied.iter('LDevice'):
+            if ld.get('inst') != ld_inst:
+                continue
+            for ln in list(ld.findall('LN0')) + list(ld.findall('LN')):
+                if ln_name(ln) == name:
+                    return ln
+        return None
+
+    def resolve(self, ref):
+        """Resolve 'LDinst/LN.DO' to (type, mag suffix, has t, has q)."""
+        try:
+            ld_inst, rest = ref.split('/', 1)
+            ln, do = rest.split('.', 1)
+        except ValueError:
+            raise GenError('invalid reference "%s"' % ref)
+        node = self.find_ln(ld_inst, ln)
+        if node is None:
+            raise GenError('logical node "%s/%s" not found' % (ld_inst, ln))
+        ln_type = self.ln_types.get(node.get('lnType'))
+        if ln_type is None:
+            raise GenError('type of "%s/%s" not found' % (ld_inst, ln))
+        dos = [d for d in ln_type.findall('DO') if d.get('name') == do]
+        if not dos:
+            raise GenError('data object "%s" not found' % ref)
+        do_type = self.do_types.get(dos[0].get('type'))
+        if do_type is None:
+            raise GenError('type of "%s" not found' % ref)
+        das = {d.get('name'): d for d in do_type.findall('DA')}
+        if 'mag' not in das:
+            raise GenError('"%s" has no mag attribute' % ref)
+        da_type = self.da_types.get(das['mag'].get('type'))
+        if da_type is None:
+            raise GenError('type of "%s.mag" not found' % ref)
+        for bda in da_type.findall('BDA'):
+            if bda.get('bType') in MAG_TYPES and \
+               bda.get('name') == MAG_TYPES[bda.get('bType')][1]:
+                c_type, suf = MAG_TYPES[bda.get('bType')]
+                return c_type, 'mag_' + suf, 't' in das, 'q' in das
+        raise GenError('"%s.mag" has neither f nor i' % ref)
+
+
+class Point:
+    """One mapped value."""
+
+    def __init__(self, idx, key, ref, scale, offset, flt):
+        self.idx = idx      # C expression of flat index
+        self.key = key      # Unique suffix for function name
+        self.ref = ref
+        self.scale = scale
+        self.offset = offset
+        self.db_abs = float(flt.get('db', 0.0))
+        self.db_pct = float(flt.get('dbp', 0.0))
+        self.min_ms = int(flt.get('min', 0))
+
+    def symbol(self, attr):
+        ld_inst, rest = self.ref.split('/', 1)
+        return 'IEDMODEL_%s_%s_%s' % (ld_inst, rest.replace('.', '_'), attr)
+
+
+def parse_points(path):
+    points = []
+    with open(path) as f:
+        for lnum, line in enumerate(f, 1):
+            tok = line.split('#', 1)[0].split()
+            if not tok:
+                continue
+            try:
+                flt = dict(t.split('=', 1) for t in tok if '=' in t)
+                tok = [t for t in tok if '=' not in t]
+                if set(flt) - {'db', 'dbp', 'min'}:
+                    raise ValueError
+                if tok[0] == 'P' and 5 <= len(tok) <= 7:
+                    ds, page, i = int(tok[1]), int(tok[2]), int(tok[3])
+                    if not (SER_MIN_DS_IDX <= ds <= SER_MAX_DS_IDX and
+                            0 <= page <= SER_MAX_PAGE_IDX and
+                            0 <= i < SER_PAGE_SIZE):
+                        raise ValueError
+                    idx = 'MAP_PAGE_IDX(%d, %d, %d)' % (ds, page, i)
+                    key = 'p%d_%d_%d' % (ds, page, i)
+                    ref, opt = tok[4], tok[5:]
+                elif tok[0] == 'S' and 3 <= len(tok) <= 5:
+                    i = int(tok[1])
+                    if not 0 <= i < SER_NUM_SUBS:
+                        raise ValueError
+                    idx = 'MAP_SUB_IDX(%d)' % i
+                    key = 's%d' % i
+                    ref, opt = tok[2], tok[3:]
+                else:
+                    raise ValueError
+                scale = float(opt[0]) if len(opt) > 0 else 1.0
+                offset = float(opt[1]) if len(opt) > 1 else 0.0
+            except ValueError:
+                raise GenError('%s:%d: invalid point' % (path, lnum))
+            if any(p.key == key for p in points):
+                raise GenError('%s:%d: duplicate point' % (path, lnum))
+            points.append(Point(idx, key, ref, scale, offset, flt))
+    return points
+
+
+def c_float(v):
+    return repr(float(v)) + 'f'
+
+
+def emit_func(p, c_type, mag, has_t, has_q):
+    """Typed update function with attributes and constants folded in."""
+    identity = (p.scale == 1.0 and p.offset == 0.0)
+    if c_type == 's32':
+        val = '(s32_t)raw' if identity else \
+            'MAP_TO_S32((f32_t)raw * %s + %s)' % (c_float(p.scale),
+                                                  c_float(p.offset))
+    else:
+        val = '(f32_t)raw' if identity else \
+            '(f32_t)raw * %s + %s' % (c_float(p.scale), c_float(p.offset))
+    head = 'static bool upd_%s(' % p.key
+    out = [
+        head + 'void *ied, const map_ent_t *ent, s16_t raw,',
+        ' ' * len(head) + 'const u32_t *ts)',
+        '{',
+        '  (void)ent;%s' % ('' if has_t else ' (void)ts;'),
+        '  bool rc = mms_if_set_attr_%s(ied, %s, %s);' % (c_type,
+                                                          p.symbol(mag), val),
+    ]
+    if has_t:
+        out.append('  rc &= mms_if_set_attr_t(ied, %s, ts);' % p.symbol('t'))
+    if has_q:
+        out.append('  rc &= mms_if_set_attr_q(ied, %s, true);' %
+                   p.symbol('q'))
+    out += ['  return rc;', '}', '']
+    return out
+
+
+def generate(model, points, out, model_h, sources):
+    name = os.path.basename(out)
+    guard = name.upper() + '_H'
+    note = 'Generated by s2m_gen.py from %s. Do not edit.' % ', '.join(
+        os.path.basename(s) for s in sources)
+
+    hdr = [
+        '/**', ' * @file %s.h' % name, ' *', ' * %s' % note, ' */', '',
+        '#ifndef %s' % guard, '#define %s' % guard, '',
+        '#include "map.h"', '',
+        '/** Static attribute mapping table. */',
+        'extern const map_ent_t %s[MAP_NUM_ENTS];' % name, '',
+        '#endif', '',
+    ]
+
+    src = [
+        '/**', ' * @file %s.c' % name, ' *', ' * %s' % note, ' */', '',
+        '#include "%s.h"' % name, '#include "%s"' % model_h,
+        '#include <stddef.h>', '',
+        '// Typed update functions', '',
+    ]
+    rows = []
+    for p in points:
+        try:
+            c_type, mag, has_t, has_q = model.resolve(p.ref)
+        except GenError as e:
+            raise GenError('point %s: %s' % (p.key, e))
+        src += emit_func(p, c_type, mag, has_t, has_q)
+        rows.append('  [%s] = { upd_%s, %s, %s, %s, %s, %s, %s, %s, %dU },' % (
+            p.idx, p.key, p.symbol(mag),
+            p.symbol('t') if has_t else 'NULL',
+            p.symbol('q') if has_q else 'NULL',
+            c_float(p.scale), c_float(p.offset),
+            c_float(p.db_abs), c_float(p.db_pct), p.min_ms))
+
+    src += ['// Mapping table', '',
+            'const map_ent_t %s[MAP_NUM_ENTS] = {' % name] + rows + ['};', '']
+
+    os.makedirs(os.path.dirname(out) or '.', exist_ok=True)
+    with open(out + '.h', 'w') as f:
+        f.write('\n'.join(hdr))
+    with open(out + '.c', 'w') as f:
+        f.write('\n'.join(src))
+
+
+def main():
+    ap = argparse.ArgumentParser(description='ser2mms static map generator')
+    ap.add_argument('--icd', required=True, help='ICD/CID/SCL file')
+    ap.add_argument('--points', required=True, help='point list file')
+    ap.add_argument('--out', required=True, help='output path without ext')
+    ap.add_argument('--ied', help='IED name (first IED by default)')
+    ap.add_argument('--model-header', default='static_model.h',
+                    help='header of libiec61850 static model')
+    args = ap.parse_args()
+    try:
+        model = Model(args.icd, args.ied)
+        points = parse_points(args.points)
+        generate(model, points, args.out, args.model_header,
+                 [args.icd, args.points])
+    except (GenError, ET.ParseError, OSError) as e:
+        sys.stderr.write('s2m_gen: %s\n' % e)
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())